@@ -7,11 +7,25 @@
 #include <eosiolib/singleton.hpp>
 #include <eosiolib/time.hpp>
 #include <string>
+#include <vector>
 
 namespace eosio {
 
 using transaction_id_type = capi_checksum256;
 
+struct feedback_info {
+    transaction_id_type trx_id;
+    string remote_trx_id;
+    string memo;
+};
+
+struct deposit_info {
+    name to;
+    asset quantity;
+    string remote_trx_id;
+    string memo;
+};
+
 class[[eosio::contract("bos.pegtoken")]] pegtoken : public contract
 {
 public:
@@ -23,6 +37,10 @@ public:
 
     [[eosio::action]] void setlimit( asset max_limit, asset min_limit, asset total_limit, uint64_t frequency_limit, uint64_t interval_limit );
 
+    [[eosio::action]] void setratelimit( symbol_code sym_code, asset burst, asset sustained, uint32_t burst_count, uint32_t count_per_day );
+
+    [[eosio::action]] void quota( symbol_code sym_code, name owner );
+
     [[eosio::action]] void setauditor( symbol_code sym_code, string action, name auditor );
 
     [[eosio::action]] void setfee( double service_fee_rate, asset min_service_fee, asset miner_fee );
@@ -37,16 +55,22 @@ public:
 
     [[eosio::action]] void assignaddr( symbol_code sym_code, name to, string address );
 
+    [[eosio::action]] void loadaddrs( symbol_code sym_code, std::vector< string > addresses );
+
     [[eosio::action]] void withdraw( name from, string to, asset quantity, string memo );
 
     [[eosio::action]] void deposit( name to, asset quantity, string memo );
 
+    [[eosio::action]] void depositmany( symbol_code sym_code, std::vector< deposit_info > items );
+
     [[eosio::action]] void transfer( name from, name to, asset quantity, string memo );
 
     [[eosio::action]] void clear( symbol_code sym_code, uint64_t num );
 
     [[eosio::action]] void feedback( symbol_code sym_code, transaction_id_type trx_id, string remote_trx_id, string memo );
 
+    [[eosio::action]] void feedbackmany( symbol_code sym_code, std::vector< feedback_info > feedbacks );
+
     [[eosio::action]] void rollback( symbol_code sym_code, transaction_id_type trx_id, string memo );
 
     [[eosio::action]] void setacceptor( symbol_code sym_code, name acceptor );
@@ -59,18 +83,29 @@ public:
 
     [[eosio::action]] void approve( symbol_code sym_code, name auditor, transaction_id_type trx_id, string memo );
 
+    [[eosio::action]] void approvemany( symbol_code sym_code, name auditor, std::vector< transaction_id_type > trx_ids );
+
     [[eosio::action]] void unapprove( symbol_code sym_code, name auditor, transaction_id_type trx_id, string memo );
 
     [[eosio::action]] void sendback( name auditor, transaction_id_type trx_id, name to, asset quantity, string memo );
 
     [[eosio::action]] void rmwithdraw( uint64_t id, symbol_code sym_code );
 
+    [[eosio::action]] void cleanup( symbol_code sym_code, uint64_t max );
+
 private:
     void verify_address( name style, string address );
     void add_balance( name owner, asset value, name ram_payer );
     void sub_balance( name owner, asset value );
     asset calculate_service_fee( asset sum, double service_fee_rate, asset min_service_fee );
 
+    void enqueue_cleanup( symbol_code sym_code, uint64_t id, uint64_t delayday );
+
+    name legacy_owner( symbol_code sym_code, const string& address );
+
+    void check_auditor( symbol_code sym_code, name auditor );
+    void approve_one( symbol_code sym_code, name auditor, const transaction_id_type& trx_id, const string& memo );
+
     bool balance_check( symbol_code sym_code, name user );
     bool addr_check( symbol_code sym_code, name user );
 
@@ -101,6 +136,27 @@ private:
         uint64_t by_state() const { return state; }
     };
 
+    // collision-free index of assigned addresses, see address_key()
+    struct [[eosio::table]] addrkey_ts {
+        name owner;
+        fixed_bytes< 32 > key;
+
+        uint64_t primary_key() const { return owner.value; }
+
+        fixed_bytes< 32 > by_key() const { return key; }
+    };
+
+    // verified addresses waiting to be handed out by applyaddr
+    struct [[eosio::table]] addrpool_ts {
+        uint64_t id;
+        string address;
+        fixed_bytes< 32 > key;
+
+        uint64_t primary_key() const { return id; }
+
+        fixed_bytes< 32 > by_key() const { return key; }
+    };
+
     struct [[eosio::table]] operate_ts {
         uint64_t id;
         name to;
@@ -153,6 +209,39 @@ private:
         static fixed_bytes< 32 > trxid( transaction_id_type trx_id ) { return fixed_bytes< 32 >( trx_id.hash ); }
     };
 
+    // withdraws no auditor has approved or unapproved yet, with what an auditor needs to pick them
+    struct [[eosio::table]] pending_ts {
+        uint64_t id;
+        transaction_id_type trx_id;
+        name from;
+        asset quantity;
+        uint64_t state;
+        bool enable;
+        time_point_sec create_time;
+
+        uint64_t primary_key() const { return id; }
+
+        uint128_t by_queindex() const
+        {
+            uint128_t index = enable ? 1 : 0;
+            index <<= 32;
+            index += state;
+            index <<= 64;
+            index += id;
+            return index;
+        }
+    };
+
+    // settled withdraws waiting for deletion, in due order
+    struct [[eosio::table]] cleanup_ts {
+        uint64_t id;
+        time_point_sec due_time;
+
+        uint64_t primary_key() const { return id; }
+
+        uint64_t by_due() const { return due_time.utc_seconds; }
+    };
+
     struct [[eosio::table]] deposit_ts {
         uint64_t id;
         transaction_id_type trx_id;
@@ -181,6 +270,28 @@ private:
         uint64_t primary_key() const { return owner.value; }
     };
 
+    // token bucket limits on withdraws; when set they replace the daily statistics window
+    struct [[eosio::table]] ratelimit_ts {
+        asset burst;
+        asset sustained;
+        uint32_t burst_count;
+        uint32_t count_per_day;
+
+        uint64_t primary_key() const { return burst.symbol.code().raw(); }
+    };
+
+    // a user's withdraw bucket as of update_time
+    struct [[eosio::table]] bucket_ts {
+        name owner;
+        int64_t amount;
+        uint64_t count; // withdraws scaled by ONE_DAY so refills stay exact
+        time_point_sec update_time;
+
+        uint64_t primary_key() const { return owner.value; }
+
+        void refill( const ratelimit_ts& limit, time_point_sec at );
+    };
+
     struct [[eosio::table]] account_ts {
         asset balance;
 
@@ -226,6 +337,12 @@ private:
         indexed_by< "addr"_n, const_mem_fun< addr_ts, uint64_t, &addr_ts::by_addr > >,
         indexed_by< "state"_n, const_mem_fun< addr_ts, uint64_t, &addr_ts::by_state > > >;
 
+    using addrkeys = eosio::multi_index< "addrkeys"_n, addrkey_ts,
+        indexed_by< "key"_n, const_mem_fun< addrkey_ts, fixed_bytes< 32 >, &addrkey_ts::by_key > > >;
+
+    using addrpool = eosio::multi_index< "addrpool"_n, addrpool_ts,
+        indexed_by< "key"_n, const_mem_fun< addrpool_ts, fixed_bytes< 32 >, &addrpool_ts::by_key > > >;
+
     using operates = eosio::multi_index< "operates"_n, operate_ts >;
 
     using withdraws = eosio::multi_index< "withdraws"_n, withdraw_ts,
@@ -233,11 +350,21 @@ private:
         indexed_by< "delindex"_n, const_mem_fun< withdraw_ts, uint128_t, &withdraw_ts::by_delindex > >,
         indexed_by< "queindex"_n, const_mem_fun< withdraw_ts, uint128_t, &withdraw_ts::by_queindex > > >;
 
+    using pendings = eosio::multi_index< "pendings"_n, pending_ts,
+        indexed_by< "queindex"_n, const_mem_fun< pending_ts, uint128_t, &pending_ts::by_queindex > > >;
+
+    using cleanups = eosio::multi_index< "cleanups"_n, cleanup_ts,
+        indexed_by< "due"_n, const_mem_fun< cleanup_ts, uint64_t, &cleanup_ts::by_due > > >;
+
     using deposits = eosio::multi_index< "deposits"_n, deposit_ts,
         indexed_by< "delindex"_n, const_mem_fun< deposit_ts, uint64_t, &deposit_ts::by_delindex > > >;
 
     using statistics = eosio::multi_index< "statistics"_n, statistic_ts >;
 
+    using ratelimits = eosio::multi_index< "ratelimits"_n, ratelimit_ts >;
+
+    using buckets = eosio::multi_index< "buckets"_n, bucket_ts >;
+
     using accounts = eosio::multi_index< "accounts"_n, account_ts >;
 
     using stats = eosio::multi_index< "stats"_n, stat_ts,
@@ -245,6 +372,14 @@ private:
         indexed_by< "acceptor"_n, const_mem_fun< stat_ts, uint64_t, &stat_ts::by_acceptor > > >;
 
     using auditors = eosio::multi_index< "auditors"_n, auditor_ts >;
+
+    bucket_ts current_bucket( const ratelimit_ts& limit, name owner );
+
+    void update_pending( symbol_code sym_code, const withdraw_ts& withdraw );
+    void erase_pending( symbol_code sym_code, uint64_t id );
+
+    void record_deposit( const stat_ts& stat, name to, const asset& quantity, const string& remote_trx_id, const string& memo );
+    void feedback_one( symbol_code sym_code, const stat_ts& stat, const transaction_id_type& trx_id, const string& remote_trx_id );
 };
 
 } // namespace eosio
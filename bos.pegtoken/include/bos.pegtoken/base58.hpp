@@ -0,0 +1,199 @@
+#pragma once
+
+// plain C++ with no eosiolib dependency, so the decoders can also be built natively
+// (see tests/bench/pegtoken_base58_bench.cpp)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace eosio {
+
+namespace decoder_detail {
+
+    constexpr char base58_alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+    constexpr char bech32_charset[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+    // character -> digit value, -1 for characters outside the alphabet
+    struct reverse_map {
+        int8_t value[256];
+
+        constexpr reverse_map(const char* alphabet, int size, bool fold_case)
+            : value {}
+        {
+            for (int i = 0; i < 256; ++i)
+                value[i] = -1;
+            for (int i = 0; i < size; ++i) {
+                auto c = static_cast<uint8_t>(alphabet[i]);
+                value[c] = i;
+                if (fold_case && c >= 'a' && c <= 'z')
+                    value[c - 'a' + 'A'] = i;
+            }
+        }
+    };
+
+    constexpr reverse_map base58_map(base58_alphabet, 58, false);
+
+    constexpr reverse_map bech32_map(bech32_charset, 32, true);
+
+    // 58^k for k digits folded into one 32-bit chunk (58^5 < 2^32)
+    constexpr uint32_t pow58[] = { 1, 58, 3364, 195112, 11316496, 656356768 };
+
+    // xor of the BCH generator terms selected by the five bits shifted out of the checksum
+    struct polymod_table {
+        uint32_t value[32];
+
+        constexpr polymod_table()
+            : value {}
+        {
+            constexpr uint32_t gen[] = { 0x3b6a57b2, 0x26508e6d, 0x1ea119fa, 0x3d4233dd, 0x2a1462b3 };
+            for (int b = 0; b < 32; ++b)
+                for (int i = 0; i < 5; ++i)
+                    if ((b >> i) & 1)
+                        value[b] ^= gen[i];
+        }
+    };
+
+    constexpr polymod_table polymod_gen;
+
+    constexpr uint32_t polymod_step(uint32_t chk, uint8_t v)
+    {
+        return (((chk & 0x1ffffff) << 5) ^ v) ^ polymod_gen.value[chk >> 25];
+    }
+
+    constexpr uint32_t bech32_const = 1;
+    constexpr uint32_t bech32m_const = 0x2bc830a3;
+
+    constexpr char to_lower(char c) { return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c; }
+
+} // namespace decoder_detail
+
+// decodes a base58 string into 25 big-endian bytes; false on a character outside the
+// alphabet or a value that does not fit. digits are folded five at a time into one
+// multiply-accumulate pass over seven 32-bit limbs
+inline bool unbase58(const char* s, unsigned char* out)
+{
+    constexpr int limbs = 7; // 28 bytes, of which the top 3 must stay zero
+    uint32_t n[limbs] = {};
+
+    while (*s) {
+        uint32_t chunk = 0;
+        int k = 0;
+        for (; k < 5 && *s; ++k, ++s) {
+            auto d = decoder_detail::base58_map.value[static_cast<uint8_t>(*s)];
+            if (d < 0)
+                return false;
+            chunk = chunk * 58 + d;
+        }
+
+        uint64_t carry = chunk;
+        const uint64_t mul = decoder_detail::pow58[k];
+        for (int j = limbs; j--;) {
+            carry += mul * n[j];
+            n[j] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+
+        // address too long
+        if (carry || (n[0] >> 8))
+            return false;
+    }
+
+    out[0] = static_cast<unsigned char>(n[0]);
+    for (int j = 1; j < limbs; ++j) {
+        out[4 * j - 3] = static_cast<unsigned char>(n[j] >> 24);
+        out[4 * j - 2] = static_cast<unsigned char>(n[j] >> 16);
+        out[4 * j - 1] = static_cast<unsigned char>(n[j] >> 8);
+        out[4 * j] = static_cast<unsigned char>(n[j]);
+    }
+    return true;
+}
+
+// longest witness program, see BIP141
+constexpr size_t max_witness_program = 40;
+
+// decodes a segwit address with human readable part `hrp` (lowercase), see BIP173 and BIP350:
+// bech32 checksum for witness version 0, bech32m for versions 1 to 16. `program` must hold
+// max_witness_program bytes; on success it holds `program_len` of them
+inline bool decode_segwit_addr(const char* addr, size_t len, const char* hrp,
+    uint8_t& version, uint8_t* program, size_t& program_len)
+{
+    using namespace decoder_detail;
+
+    const size_t hrp_len = std::strlen(hrp);
+    if (len < hrp_len + 8 || len > 90)
+        return false;
+
+    bool lower = false, upper = false;
+    for (size_t i = 0; i < len; ++i) {
+        char c = addr[i];
+        if (c < 33 || c > 126)
+            return false;
+        lower |= (c >= 'a' && c <= 'z');
+        upper |= (c >= 'A' && c <= 'Z');
+    }
+    if (lower && upper)
+        return false;
+
+    if (addr[hrp_len] != '1')
+        return false;
+    for (size_t i = 0; i < hrp_len; ++i)
+        if (to_lower(addr[i]) != hrp[i])
+            return false;
+
+    uint32_t chk = 1;
+    for (size_t i = 0; i < hrp_len; ++i)
+        chk = polymod_step(chk, static_cast<uint8_t>(hrp[i]) >> 5);
+    chk = polymod_step(chk, 0);
+    for (size_t i = 0; i < hrp_len; ++i)
+        chk = polymod_step(chk, static_cast<uint8_t>(hrp[i]) & 31);
+
+    // witness version, program in 5-bit groups, 6 checksum characters
+    const char* data = addr + hrp_len + 1;
+    const size_t data_len = len - hrp_len - 1;
+    const size_t program_end = data_len - 6;
+
+    version = 0;
+    program_len = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < data_len; ++i) {
+        auto v = bech32_map.value[static_cast<uint8_t>(data[i])];
+        if (v < 0)
+            return false;
+        chk = polymod_step(chk, v);
+
+        if (i == 0) {
+            version = v;
+        } else if (i < program_end) {
+            acc = ((acc << 5) | v) & 0xfff;
+            bits += 5;
+            if (bits >= 8) {
+                bits -= 8;
+                if (program_len == max_witness_program)
+                    return false;
+                program[program_len++] = static_cast<uint8_t>(acc >> bits);
+            }
+        }
+    }
+
+    // at most 4 bits of zero padding
+    if (bits > 4 || (acc & ((1u << bits) - 1)))
+        return false;
+    if (version > 16 || program_len < 2)
+        return false;
+    if (version == 0 && program_len != 20 && program_len != 32)
+        return false;
+    return chk == (version == 0 ? bech32_const : bech32m_const);
+}
+
+inline bool valid_segwit_addr(const char* addr, size_t len, const char* hrp)
+{
+    uint8_t version;
+    uint8_t program[max_witness_program];
+    size_t program_len;
+    return decode_segwit_addr(addr, len, hrp, version, program, program_len);
+}
+
+} // namespace eosio
@@ -1,6 +1,7 @@
 #pragma once
 
-#include "sha3.h"
+#include "base58.hpp"
+#include "eip55.hpp"
 #include <algorithm>
 #include <cstdio>
 #include <eosiolib/crypto.h>
@@ -59,37 +60,26 @@ string decode_hex(const void* data, uint64_t len)
     return str;
 }
 
-bool unbase58(const char* s, unsigned char* out)
-{
-    static const char* tmpl = "123456789"
-                              "ABCDEFGHJKLMNPQRSTUVWXYZ"
-                              "abcdefghijkmnopqrstuvwxyz";
-    int i, j, c;
-    const char* p;
-
-    memset(out, 0, 25);
-    for (i = 0; s[i]; i++) {
-        if (!(p = std::strchr(tmpl, s[i])))
-            return false;
-
-        c = p - tmpl;
-        for (j = 25; j--;) {
-            c += 58 * out[j];
-            out[j] = c % 256;
-            c /= 256;
-        }
-
-        // address too long
-        if (c)
-            return false;
-    }
+// bitcoin segwit addresses start with the human readable part and separator "1"
+#ifdef TESTNET
+constexpr char segwit_hrp[] = "tb";
+#else
+constexpr char segwit_hrp[] = "bc";
+#endif
 
-    return true;
+inline bool has_segwit_prefix(const string& addr)
+{
+    return addr.size() > 3 && decoder_detail::to_lower(addr[0]) == segwit_hrp[0]
+        && decoder_detail::to_lower(addr[1]) == segwit_hrp[1] && addr[2] == '1';
 }
 
-// see http://rosettacode.org/wiki/Bitcoin/address_validation#C
+// base58check, see http://rosettacode.org/wiki/Bitcoin/address_validation#C;
+// bech32 and bech32m for segwit addresses
 bool valid_bitcoin_addr(string addr)
 {
+    if (has_segwit_prefix(addr))
+        return valid_segwit_addr(addr.data(), addr.size(), segwit_hrp);
+
     if (addr.size() < 26 || addr.size() > 35)
         return false;
 
@@ -97,9 +87,7 @@ bool valid_bitcoin_addr(string addr)
     if (addr[0] != '2' && addr[0] != '9' && addr[0] != 'm' && addr[0] != 'n')
         return false;
 #else
-    string bc1("bc1");
-    if (addr[0] != '1' && addr[0] != '3'
-        && std::mismatch(bc1.begin(), bc1.end(), addr.begin()).first != bc1.end())
+    if (addr[0] != '1' && addr[0] != '3')
         return false;
 #endif
 
@@ -107,56 +95,24 @@ bool valid_bitcoin_addr(string addr)
     if (!unbase58(addr.c_str(), dec))
         return false;
 
+    // the base58check checksum is defined as a double sha256
     capi_checksum256 tmp, res;
     sha256(reinterpret_cast<const char*>(dec), 21, &tmp);
     sha256(reinterpret_cast<const char*>(tmp.hash), 32, &res);
     return std::memcmp(dec + 21, res.hash, 4) ? false : true;
 }
 
-bool valid_ethereum_addr(string addr)
+bool valid_ethereum_addr_strict(const string& addr)
 {
-    auto prefix_index = addr.find("0x");
-    if (prefix_index == 0)
-        addr = addr.substr(prefix_index + 2);
-
-    eosio_assert(addr.size() == 40, "invalid eth adr len, expected: 40");
-
-    for (auto&& r : addr) {
-        if (!(r >= '0' && r <= '9')
-            && !(r >= 'a' && r <= 'z')
-            && !(r >= 'A' && r <= 'Z')) {
-            return false;
-        }
-    }
-    return true;
+    const size_t offset = addr.compare(0, 2, "0x") == 0 ? 2 : 0;
+    eosio_assert(addr.size() == offset + 40, "invalid eth adr len, expected: 40");
+    return valid_eip55_checksum(addr.data() + offset);
 }
 
-bool valid_ethereum_addr_strict(string addr)
+// ethereum addresses must carry their EIP-55 checksum
+bool valid_ethereum_addr(const string& addr)
 {
-    auto prefix_index = addr.find("0x");
-    if (prefix_index == 0)
-        addr = addr.substr(prefix_index + 2);
-
-    eosio_assert(addr.size() == 40, "invalid eth adr len, expected: 40");
-
-    auto origin_addr = addr;
-
-    std::transform(addr.begin(), addr.end(), addr.begin(), ::tolower);
-
-    uint8_t buf[addr.length()];
-    int i = 0;
-    for (auto& r : addr)
-        buf[i++] = r;
-    uint8_t out[32];
-
-    keccak_256(out, sizeof(out), buf, addr.length());
-
-    auto mask = decode_hex(out, sizeof(out));
-    for (int i = 0; i < addr.size(); ++i) {
-        addr[i] = (hex_to_digit(mask[i]) > 7) ? ::toupper(addr[i]) : ::tolower(addr[i]);
-    }
-
-    return addr == origin_addr;
+    return valid_ethereum_addr_strict(addr);
 }
 
 bool valid_usdt_addr(string addr)
@@ -0,0 +1,149 @@
+#pragma once
+
+// plain C++ with no eosiolib dependency, see tests/bench/pegtoken_eip55_bench.cpp
+
+#include <cstddef>
+#include <cstdint>
+
+namespace eosio {
+
+namespace decoder_detail {
+
+    constexpr uint64_t keccak_round_constants[24] = {
+        0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+        0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+        0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+        0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+        0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+        0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+    };
+
+    constexpr uint64_t rotl(uint64_t x, int s) { return (x << s) | (x >> (64 - s)); }
+
+    // -1 for anything but [0-9a-fA-F]
+    struct hex_map_table {
+        int8_t value[256];
+
+        constexpr hex_map_table()
+            : value {}
+        {
+            for (int i = 0; i < 256; ++i)
+                value[i] = -1;
+            for (int i = 0; i < 10; ++i)
+                value['0' + i] = i;
+            for (int i = 0; i < 6; ++i)
+                value['a' + i] = value['A' + i] = 10 + i;
+        }
+    };
+
+    constexpr hex_map_table hex_digits;
+
+} // namespace decoder_detail
+
+// Keccak-f[1600] on 25 lanes indexed x + 5y, each round written out lane by lane
+inline void keccak_f1600(uint64_t a[25])
+{
+    using decoder_detail::rotl;
+
+    for (int round = 0; round < 24; ++round) {
+        const uint64_t c0 = a[0] ^ a[5] ^ a[10] ^ a[15] ^ a[20];
+        const uint64_t c1 = a[1] ^ a[6] ^ a[11] ^ a[16] ^ a[21];
+        const uint64_t c2 = a[2] ^ a[7] ^ a[12] ^ a[17] ^ a[22];
+        const uint64_t c3 = a[3] ^ a[8] ^ a[13] ^ a[18] ^ a[23];
+        const uint64_t c4 = a[4] ^ a[9] ^ a[14] ^ a[19] ^ a[24];
+        const uint64_t d0 = c4 ^ rotl(c1, 1);
+        const uint64_t d1 = c0 ^ rotl(c2, 1);
+        const uint64_t d2 = c1 ^ rotl(c3, 1);
+        const uint64_t d3 = c2 ^ rotl(c4, 1);
+        const uint64_t d4 = c3 ^ rotl(c0, 1);
+
+        // rho and pi, theta folded in
+        const uint64_t b00 = a[0] ^ d0;
+        const uint64_t b01 = rotl(a[6] ^ d1, 44);
+        const uint64_t b02 = rotl(a[12] ^ d2, 43);
+        const uint64_t b03 = rotl(a[18] ^ d3, 21);
+        const uint64_t b04 = rotl(a[24] ^ d4, 14);
+        const uint64_t b05 = rotl(a[3] ^ d3, 28);
+        const uint64_t b06 = rotl(a[9] ^ d4, 20);
+        const uint64_t b07 = rotl(a[10] ^ d0, 3);
+        const uint64_t b08 = rotl(a[16] ^ d1, 45);
+        const uint64_t b09 = rotl(a[22] ^ d2, 61);
+        const uint64_t b10 = rotl(a[1] ^ d1, 1);
+        const uint64_t b11 = rotl(a[7] ^ d2, 6);
+        const uint64_t b12 = rotl(a[13] ^ d3, 25);
+        const uint64_t b13 = rotl(a[19] ^ d4, 8);
+        const uint64_t b14 = rotl(a[20] ^ d0, 18);
+        const uint64_t b15 = rotl(a[4] ^ d4, 27);
+        const uint64_t b16 = rotl(a[5] ^ d0, 36);
+        const uint64_t b17 = rotl(a[11] ^ d1, 10);
+        const uint64_t b18 = rotl(a[17] ^ d2, 15);
+        const uint64_t b19 = rotl(a[23] ^ d3, 56);
+        const uint64_t b20 = rotl(a[2] ^ d2, 62);
+        const uint64_t b21 = rotl(a[8] ^ d3, 55);
+        const uint64_t b22 = rotl(a[14] ^ d4, 39);
+        const uint64_t b23 = rotl(a[15] ^ d0, 41);
+        const uint64_t b24 = rotl(a[21] ^ d1, 2);
+
+        // chi
+        a[0] = b00 ^ (~b01 & b02);
+        a[1] = b01 ^ (~b02 & b03);
+        a[2] = b02 ^ (~b03 & b04);
+        a[3] = b03 ^ (~b04 & b00);
+        a[4] = b04 ^ (~b00 & b01);
+        a[5] = b05 ^ (~b06 & b07);
+        a[6] = b06 ^ (~b07 & b08);
+        a[7] = b07 ^ (~b08 & b09);
+        a[8] = b08 ^ (~b09 & b05);
+        a[9] = b09 ^ (~b05 & b06);
+        a[10] = b10 ^ (~b11 & b12);
+        a[11] = b11 ^ (~b12 & b13);
+        a[12] = b12 ^ (~b13 & b14);
+        a[13] = b13 ^ (~b14 & b10);
+        a[14] = b14 ^ (~b10 & b11);
+        a[15] = b15 ^ (~b16 & b17);
+        a[16] = b16 ^ (~b17 & b18);
+        a[17] = b17 ^ (~b18 & b19);
+        a[18] = b18 ^ (~b19 & b15);
+        a[19] = b19 ^ (~b15 & b16);
+        a[20] = b20 ^ (~b21 & b22);
+        a[21] = b21 ^ (~b22 & b23);
+        a[22] = b22 ^ (~b23 & b24);
+        a[23] = b23 ^ (~b24 & b20);
+        a[24] = b24 ^ (~b20 & b21);
+
+        a[0] ^= decoder_detail::keccak_round_constants[round];
+    }
+}
+
+// EIP-55 mixed-case checksum of the 40 hex digits at `hex` (no 0x prefix): each letter
+// is uppercase exactly when the matching nibble of keccak256(lowercase address) is >= 8.
+// the lowercase address fits a single 136-byte block, so it is absorbed straight into
+// the state and only the first 20 bytes of the digest are read
+inline bool valid_eip55_checksum(const char* hex)
+{
+    uint64_t a[25] = {};
+    for (int i = 0; i < 40; ++i) {
+        auto c = static_cast<uint8_t>(hex[i]);
+        if (decoder_detail::hex_digits.value[c] < 0)
+            return false;
+        a[i / 8] |= uint64_t(c | 0x20) << (8 * (i % 8));
+    }
+    // keccak padding: domain byte 0x01 after the message, 0x80 in the last byte of the rate
+    a[5] ^= 0x01;
+    a[16] ^= 0x8000000000000000ULL;
+
+    keccak_f1600(a);
+
+    for (int i = 0; i < 40; ++i) {
+        const uint8_t c = hex[i];
+        if (c < 'A')
+            continue;
+        const uint8_t byte = a[i / 16] >> (8 * ((i / 2) % 8));
+        const uint8_t nibble = (i % 2) ? (byte & 0x0f) : (byte >> 4);
+        if ((nibble >= 8) != (c <= 'F'))
+            return false;
+    }
+    return true;
+}
+
+} // namespace eosio
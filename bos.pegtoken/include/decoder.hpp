@@ -1,6 +1,7 @@
 #pragma once
 
-#include "sha3.h"
+#include "bos.pegtoken/base58.hpp"
+#include "bos.pegtoken/eip55.hpp"
 #include <algorithm>
 #include <cstdio>
 #include <eosiolib/crypto.h>
@@ -37,37 +38,26 @@ string decode_hex(const void* data, uint64_t len)
     return str;
 }
 
-bool unbase58(const char* s, unsigned char* out)
-{
-    static const char* tmpl = "123456789"
-                              "ABCDEFGHJKLMNPQRSTUVWXYZ"
-                              "abcdefghijkmnopqrstuvwxyz";
-    int i, j, c;
-    const char* p;
-
-    memset(out, 0, 25);
-    for (i = 0; s[i]; i++) {
-        if (!(p = std::strchr(tmpl, s[i])))
-            return false;
-
-        c = p - tmpl;
-        for (j = 25; j--;) {
-            c += 58 * out[j];
-            out[j] = c % 256;
-            c /= 256;
-        }
-
-        // address too long
-        if (c)
-            return false;
-    }
+// bitcoin segwit addresses start with the human readable part and separator "1"
+#ifdef TESTNET
+constexpr char segwit_hrp[] = "tb";
+#else
+constexpr char segwit_hrp[] = "bc";
+#endif
 
-    return true;
+inline bool has_segwit_prefix(const string& addr)
+{
+    return addr.size() > 3 && decoder_detail::to_lower(addr[0]) == segwit_hrp[0]
+        && decoder_detail::to_lower(addr[1]) == segwit_hrp[1] && addr[2] == '1';
 }
 
-// see http://rosettacode.org/wiki/Bitcoin/address_validation#C
+// base58check, see http://rosettacode.org/wiki/Bitcoin/address_validation#C;
+// bech32 and bech32m for segwit addresses
 bool valid_bitcoin_addr(string addr)
 {
+    if (has_segwit_prefix(addr))
+        return valid_segwit_addr(addr.data(), addr.size(), segwit_hrp);
+
     if (addr.size() < 26 || addr.size() > 35)
         return false;
 
@@ -75,9 +65,7 @@ bool valid_bitcoin_addr(string addr)
     if (addr[0] != '2' && addr[0] != '9' && addr[0] != 'm' && addr[0] != 'n')
         return false;
 #else
-    string bc1("bc1");
-    if (addr[0] != '1' && addr[0] != '3'
-        && std::mismatch(bc1.begin(), bc1.end(), addr.begin()).first != bc1.end())
+    if (addr[0] != '1' && addr[0] != '3')
         return false;
 #endif
 
@@ -85,48 +73,37 @@ bool valid_bitcoin_addr(string addr)
     if (!unbase58(addr.c_str(), dec))
         return false;
 
+    // the base58check checksum is defined as a double sha256
     capi_checksum256 tmp, res;
     sha256(reinterpret_cast<const char*>(dec), 21, &tmp);
     sha256(reinterpret_cast<const char*>(tmp.hash), 32, &res);
     return std::memcmp(dec + 21, res.hash, 4) ? false : true;
 }
 
-bool valid_ethereum_addr(string addr)
+// checksummed (EIP-55) addresses only
+bool valid_ethereum_addr(const string& addr)
 {
-    auto prefix_index = addr.find("0x");
-    if (prefix_index == 0)
-        addr = addr.substr(prefix_index + 2);
-
-    eosio_assert(addr.size() == 40, "invalid eth adr len, expected: 40");
-
-    auto origin_addr = addr;
-
-    std::transform(addr.begin(), addr.end(), addr.begin(), ::tolower);
-
-    uint8_t buf[addr.length()];
-    int i = 0;
-    for (auto& r : addr)
-        buf[i++] = r;
-    uint8_t out[32];
-
-    keccak_256(out, sizeof(out), buf, addr.length());
-
-    auto mask = decode_hex(out, sizeof(out));
-    for (int i = 0; i < addr.size(); ++i) {
-        addr[i] = (hex_to_digit(mask[i]) > 7) ? ::toupper(addr[i]) : ::tolower(addr[i]);
-    }
-
-    return addr == origin_addr;
+    const size_t offset = addr.compare(0, 2, "0x") == 0 ? 2 : 0;
+    eosio_assert(addr.size() == offset + 40, "invalid eth adr len, expected: 40");
+    return valid_eip55_checksum(addr.data() + offset);
 }
 
-capi_checksum256 get_trx_id()
+// every action runs in a fresh instance, so the id is hashed at most once per action
+// no matter how many rows of a batch record it
+const capi_checksum256& get_trx_id()
 {
-    capi_checksum256 trx_id;
-    std::vector<char> trx_bytes;
-    size_t trx_size = transaction_size();
-    trx_bytes.resize(trx_size);
-    read_transaction(trx_bytes.data(), trx_size);
-    sha256(trx_bytes.data(), trx_size, &trx_id);
+    static capi_checksum256 trx_id;
+    static bool cached = false;
+    if (!cached) {
+        constexpr size_t max_stack_buffer_size = 512;
+        size_t trx_size = transaction_size();
+        char* buffer = (char*)(max_stack_buffer_size < trx_size ? malloc(trx_size) : alloca(trx_size));
+        read_transaction(buffer, trx_size);
+        sha256(buffer, trx_size, &trx_id);
+        if (max_stack_buffer_size < trx_size)
+            free(buffer);
+        cached = true;
+    }
     return trx_id;
 }
 
@@ -135,6 +112,46 @@ string checksum256_to_string(capi_checksum256 src)
     return decode_hex(src.hash, 32);
 }
 
+// canonical binary form of an address packed into 32 bytes: the witness version and program of
+// a segwit address, decoded base58 for other bitcoin addresses, the 20 raw bytes for ethereum and
+// the string itself otherwise. forms shorter than 32 bytes are stored as length + bytes, longer
+// ones as their sha256; so a P2WPKH address is stored as is, while 32-byte witness programs
+// (P2WSH, P2TR) and `other` addresses of 32 characters or more are hashed
+fixed_bytes<32> address_key(name style, const string& addr)
+{
+    auto form = reinterpret_cast<const uint8_t*>(addr.data());
+    size_t len = addr.size();
+
+    uint8_t canonical[1 + max_witness_program];
+    size_t program_len;
+    if (style == "bitcoin"_n && has_segwit_prefix(addr)
+        && decode_segwit_addr(addr.data(), addr.size(), segwit_hrp, canonical[0], canonical + 1, program_len)) {
+        form = canonical;
+        len = 1 + program_len;
+    } else if (style == "bitcoin"_n && addr.size() <= 35 && unbase58(addr.c_str(), canonical)) {
+        form = canonical;
+        len = 25;
+    } else if (style == "ethereum"_n) {
+        auto hex = addr.compare(0, 2, "0x") == 0 ? addr.substr(2) : addr;
+        eosio_assert(hex.size() == 40, "invalid eth adr len, expected: 40");
+        for (size_t i = 0; i < 20; ++i)
+            canonical[i] = (hex_to_digit(hex[2 * i]) << 4) | hex_to_digit(hex[2 * i + 1]);
+        form = canonical;
+        len = 20;
+    }
+
+    uint8_t key[32] = {};
+    if (len < 32) {
+        key[0] = len;
+        std::memcpy(key + 1, form, len);
+    } else {
+        capi_checksum256 hash256;
+        sha256(reinterpret_cast<const char*>(form), len, &hash256);
+        std::memcpy(key, hash256.hash, 32);
+    }
+    return fixed_bytes<32>(key);
+}
+
 uint64_t hash64(const string s)
 {
     capi_checksum256 hash256;
@@ -26,6 +26,67 @@ enum withdraw_state : uint64_t {
 // private funcs
 ////////////////////////
 
+void pegtoken::bucket_ts::refill( const ratelimit_ts& limit, time_point_sec at )
+{
+    uint64_t elapsed = at > update_time ? at.utc_seconds - update_time.utc_seconds : 0;
+    update_time = std::max( update_time, at );
+
+    // a burst lowered since the last withdraw caps what is left, even within the same second
+    int64_t room = limit.burst.amount - amount;
+    uint128_t gained = uint128_t( limit.sustained.amount ) * elapsed / ONE_DAY;
+    amount = room <= 0 || gained >= uint128_t( room ) ? limit.burst.amount : amount + int64_t( gained );
+
+    uint64_t count_cap = uint64_t( limit.burst_count ) * ONE_DAY;
+    uint128_t count_gained = uint128_t( limit.count_per_day ) * elapsed;
+    count = count >= count_cap || count_gained >= count_cap - count ? count_cap : count + uint64_t( count_gained );
+}
+
+// keeps the auditor queue in step with a withdraw, dropping it once an auditor decided
+void pegtoken::update_pending( symbol_code sym_code, const withdraw_ts& withdraw )
+{
+    auto pend = pendings( get_self(), sym_code.raw() );
+    auto iter = pend.find( withdraw.id );
+    if ( iter == pend.end() ) {
+        return;
+    }
+    if ( withdraw.auditor != NIL_ACCOUNT ) {
+        pend.erase( iter );
+        return;
+    }
+    pend.modify( iter, same_payer, [&]( auto& p ) {
+        p.state = withdraw.state;
+        p.enable = withdraw.enable;
+    } );
+}
+
+void pegtoken::erase_pending( symbol_code sym_code, uint64_t id )
+{
+    auto pend = pendings( get_self(), sym_code.raw() );
+    auto iter = pend.find( id );
+    if ( iter != pend.end() ) {
+        pend.erase( iter );
+    }
+}
+
+// the stored bucket refilled up to now, or a full one for a user who never withdrew
+pegtoken::bucket_ts pegtoken::current_bucket( const ratelimit_ts& limit, name owner )
+{
+    auto bkts = buckets( get_self(), limit.burst.symbol.code().raw() );
+    auto iter = bkts.find( owner.value );
+    if ( iter == bkts.end() ) {
+        bucket_ts full;
+        full.owner = owner;
+        full.amount = limit.burst.amount;
+        full.count = uint64_t( limit.burst_count ) * ONE_DAY;
+        full.update_time = time_point_sec( now() );
+        return full;
+    }
+
+    auto bucket = *iter;
+    bucket.refill( limit, time_point_sec( now() ) );
+    return bucket;
+}
+
 void pegtoken::verify_address( name style, string addr )
 {
     if ( style == "bitcoin"_n ) {
@@ -82,6 +143,125 @@ void pegtoken::add_balance( name owner, asset value, name ram_payer )
     }
 }
 
+void pegtoken::enqueue_cleanup( symbol_code sym_code, uint64_t id, uint64_t delayday )
+{
+    auto queue = cleanups( get_self(), sym_code.raw() );
+    auto due_time = time_point_sec( now() + delayday * ONE_DAY );
+    auto iter = queue.find( id );
+    if ( iter == queue.end() ) {
+        queue.emplace( get_self(), [&]( auto& p ) {
+            p.id = id;
+            p.due_time = due_time;
+        } );
+    } else {
+        queue.modify( iter, same_payer, [&]( auto& p ) { p.due_time = due_time; } );
+    }
+}
+
+// addresses assigned before addrkeys existed are only in the hash64 index, where a hash match
+// with a different address is a collision rather than a duplicate; so every row of the hash's
+// range is compared. returns the owner, or an empty name if the address is not assigned
+name pegtoken::legacy_owner( symbol_code sym_code, const string& address )
+{
+    auto addresses = addrs( get_self(), sym_code.raw() );
+    auto by_addr = addresses.template get_index<"addr"_n>();
+    auto h = hash64( address );
+    for ( auto iter = by_addr.lower_bound( h ), end = by_addr.upper_bound( h ); iter != end; ++iter ) {
+        if ( iter->address == address ) {
+            return iter->owner;
+        }
+    }
+    return name();
+}
+
+// the signer must be a registered auditor of an active token
+void pegtoken::check_auditor( symbol_code sym_code, name auditor )
+{
+    auto sym_raw = sym_code.raw();
+    require_auth( auditor );
+    auto stats_table = stats( get_self(), sym_raw );
+    auto iter = stats_table.find( sym_raw );
+    eosio_assert( iter != stats_table.end(), "token not exist" );
+    {
+        auto auds = auditors( get_self(), sym_raw );
+        eosio_assert( auds.find( auditor.value ) != auds.end(), "auditor not exist" );
+    }
+    eosio_assert( iter->active, "underwriter is not active" );
+}
+
+// records an approval and takes the withdraw off the pendings queue; an empty memo keeps the message
+void pegtoken::approve_one( symbol_code sym_code, name auditor, const transaction_id_type& trx_id, const string& memo )
+{
+    auto withd = withdraws( get_self(), sym_code.raw() );
+    auto trxids = withd.template get_index<"trxid"_n>();
+    auto iter2 = trxids.find( withdraw_ts::trxid( trx_id ) );
+    eosio_assert( iter2 != trxids.end(), "invalid trx_id" );
+    eosio_assert( iter2->auditor == NIL_ACCOUNT, "already been approved/unapproved" );
+    trxids.modify( iter2, same_payer, [&]( auto& p ) {
+        p.auditor = auditor;
+        p.enable = true;
+        p.msg = ( memo == "" ? p.msg : memo );
+        p.update_time = time_point_sec( now() );
+    } );
+    erase_pending( sym_code, iter2->id );
+}
+
+// checks a deposit from the acceptor of `stat` and records it; the caller moves the balance
+void pegtoken::record_deposit( const stat_ts& stat, name to, const asset& quantity, const string& remote_trx_id, const string& memo )
+{
+    STRING_LEN_CHECK( memo, 256 )
+    STRING_LEN_CHECK( remote_trx_id, 256 )
+
+    eosio_assert( quantity.is_valid(), "invalid quantity" );
+    eosio_assert( quantity.amount > 0, "must issue positive quantity" );
+    eosio_assert( quantity.symbol == stat.supply.symbol, "symbol precision mismatch" );
+
+    ACCOUNT_CHECK( to )
+    eosio_assert( to != get_self(), "to can't be contract" );
+    eosio_assert( to != stat.issuer, "to can't be issuer" );
+    eosio_assert( to != stat.acceptor, "to can't be acceptor" );
+    {
+        auto appl = applicants( get_self(), stat.supply.symbol.code().raw() );
+        eosio_assert( appl.find( to.value ) == appl.end(), "to can't be applicant " );
+    }
+
+    auto depo = deposits( get_self(), stat.supply.symbol.code().raw() );
+    depo.emplace( get_self(), [&]( auto& p ) {
+        p.id = depo.available_primary_key();
+        p.from = stat.acceptor;
+        p.trx_id = get_trx_id();
+        p.to = to.to_string();
+        p.quantity = quantity;
+        p.remote_trx_id = remote_trx_id;
+        p.update_time = time_point_sec( now() );
+        p.create_time = time_point_sec( now() );
+        p.msg = memo;
+    } );
+}
+
+// marks a withdraw as sent on the remote chain; `stat` is the token, already authorized by the caller
+void pegtoken::feedback_one( symbol_code sym_code, const stat_ts& stat, const transaction_id_type& trx_id, const string& remote_trx_id )
+{
+    STRING_LEN_CHECK( remote_trx_id, 256 )
+
+    // TODO: check remote_trx_id
+
+    auto withd = withdraws( get_self(), sym_code.raw() );
+    auto trxids = withd.template get_index<"trxid"_n>();
+    auto iter2 = trxids.find( withdraw_ts::trxid( trx_id ) );
+    eosio_assert( iter2 != trxids.end(), "this trx id does not exist" );
+    eosio_assert( iter2->state == INITIAL_STATE, "invalid state" );
+    eosio_assert( iter2->enable == true, "cannot be processed" );
+
+    enqueue_cleanup( sym_code, iter2->id, stat.delayday );
+    trxids.modify( iter2, same_payer, [&]( auto& p ) {
+        p.state = withdraw_state::FEED_BACK;
+        p.remote_trx_id = remote_trx_id;
+        p.update_time = time_point_sec( now() );
+    } );
+    update_pending( sym_code, *iter2 );
+}
+
 bool pegtoken::balance_check( symbol_code sym_code, name user )
 {
     auto acct = accounts( get_self(), user.value );
@@ -182,6 +362,55 @@ void pegtoken::setlimit( asset max_limit, asset min_limit, asset total_limit, ui
     } );
 }
 
+// burst bounds what a user with a full bucket can withdraw at once, sustained is refilled per
+// day; likewise for the number of withdraws. a zero burst removes the limits again; the buckets
+// are left in place, one per user, and each is dropped by its owner's next withdraw
+void pegtoken::setratelimit( symbol_code sym_code, asset burst, asset sustained, uint32_t burst_count, uint32_t count_per_day )
+{
+    auto sym_raw = sym_code.raw();
+    auto stats_table = stats( get_self(), sym_raw );
+    auto iter = stats_table.find( sym_raw );
+    eosio_assert( iter != stats_table.end(), "token not exist" );
+    require_auth( iter->issuer );
+
+    eosio_assert( burst.is_valid() && sustained.is_valid(), "invalid quantity" );
+    eosio_assert( burst.symbol == iter->supply.symbol && sustained.symbol == iter->supply.symbol, "symbol mismatch" );
+
+    auto rls = ratelimits( get_self(), sym_raw );
+    auto limit = rls.find( sym_raw );
+    if ( burst.amount == 0 ) {
+        eosio_assert( limit != rls.end(), "no rate limit set" );
+        rls.erase( limit );
+        return;
+    }
+
+    eosio_assert( burst.amount > 0 && sustained.amount >= 0, "burst must be positive and sustained not negative" );
+    eosio_assert( burst_count > 0, "burst_count must be positive" );
+
+    auto assign = [&]( auto& p ) {
+        p.burst = burst;
+        p.sustained = sustained;
+        p.burst_count = burst_count;
+        p.count_per_day = count_per_day;
+    };
+    if ( limit == rls.end() ) {
+        rls.emplace( get_self(), assign );
+    } else {
+        rls.modify( limit, same_payer, assign );
+    }
+}
+
+// prints the amount and number of withdraws `owner` has left right now
+void pegtoken::quota( symbol_code sym_code, name owner )
+{
+    auto sym_raw = sym_code.raw();
+    auto rls = ratelimits( get_self(), sym_raw );
+    auto& limit = rls.get( sym_raw, "no rate limit set" );
+
+    auto bucket = current_bucket( limit, owner );
+    print( asset( bucket.amount, limit.burst.symbol ), " ", bucket.count / ONE_DAY );
+}
+
 void pegtoken::setauditor( symbol_code sym_code, string action, name auditor )
 {
     { ACCOUNT_CHECK( auditor ) };
@@ -355,6 +584,26 @@ void pegtoken::applyaddr( name applicant, symbol_code sym_code, name to )
     auto addresses = addrs( get_self(), sym_code.raw() );
     eosio_assert( addresses.find( to.value ) == addresses.end(), "to account has applied for address already" );
 
+    // hand out a preloaded address right away, otherwise wait for assignaddr
+    auto pool = addrpool( get_self(), sym_code.raw() );
+    auto next = pool.begin();
+    if ( next != pool.end() ) {
+        auto keys = addrkeys( get_self(), sym_code.raw() );
+        keys.emplace( get_self(), [&]( auto& p ) {
+            p.owner = to;
+            p.key = next->key;
+        } );
+        addresses.emplace( get_self(), [&]( auto& p ) {
+            p.owner = to;
+            p.address = next->address;
+            p.state = 0;
+            p.create_time = time_point_sec( now() );
+            p.assign_time = time_point_sec( now() );
+        } );
+        pool.erase( next );
+        return;
+    }
+
     addresses.emplace( get_self(), [&]( auto& p ) {
         p.owner = to;
         p.state = to.value;
@@ -385,12 +634,37 @@ void pegtoken::assignaddr( symbol_code sym_code, name to, string address )
 
     verify_address( iter->address_style, address );
 
-    auto addresses = addrs( get_self(), sym_code.raw() );
+    auto key = address_key( iter->address_style, address );
+    auto keys = addrkeys( get_self(), sym_code.raw() );
+    {
+        auto by_key = keys.template get_index<"key"_n>();
+        auto iter1 = by_key.find( key );
+        if ( iter1 != by_key.end() ) {
+            eosio_assert( false, ( "this address " + address + " has been assigned to " + iter1->owner.to_string() ).c_str() );
+        }
+        auto pool = addrpool( get_self(), sym_code.raw() );
+        auto pooled = pool.template get_index<"key"_n>();
+        eosio_assert( pooled.find( key ) == pooled.end(), ( "this address " + address + " is already in the pool" ).c_str() );
+    }
+
+    {
+        auto owner = legacy_owner( sym_code, address );
+        if ( owner != name() ) {
+            eosio_assert( false, ( "this address " + address + " has been assigned to " + owner.to_string() ).c_str() );
+        }
+    }
 
-    auto addr = addresses.template get_index<"addr"_n>();
-    auto iter1 = addr.find( hash64( address ) );
-    eosio_assert( iter1 == addr.end(), ( "this address " + address + " has been assigned to " + iter1->owner.to_string() ).c_str() );
+    auto addresses = addrs( get_self(), sym_code.raw() );
 
+    auto iter3 = keys.find( to.value );
+    if ( iter3 == keys.end() ) {
+        keys.emplace( get_self(), [&]( auto& p ) {
+            p.owner = to;
+            p.key = key;
+        } );
+    } else {
+        keys.modify( iter3, same_payer, [&]( auto& p ) { p.key = key; } );
+    }
 
     auto iter2 = addresses.find( to.value );
     if ( iter2 == addresses.end() ) {
@@ -409,6 +683,37 @@ void pegtoken::assignaddr( symbol_code sym_code, name to, string address )
     }
 }
 
+void pegtoken::loadaddrs( symbol_code sym_code, std::vector< string > addresses )
+{
+    eosio_assert( !addresses.empty(), "addresses is empty" );
+
+    auto sym_raw = sym_code.raw();
+    auto stats_table = stats( get_self(), sym_raw );
+    auto iter = stats_table.find( sym_raw );
+    eosio_assert( iter != stats_table.end(), "token not exist" );
+    require_auth( iter->acceptor );
+
+    auto pool = addrpool( get_self(), sym_raw );
+    auto pooled = pool.template get_index<"key"_n>();
+    auto keys = addrkeys( get_self(), sym_raw );
+    auto assigned = keys.template get_index<"key"_n>();
+    for ( const auto& address : addresses ) {
+        STRING_LEN_CHECK( address, 64 )
+        verify_address( iter->address_style, address );
+
+        auto key = address_key( iter->address_style, address );
+        eosio_assert( pooled.find( key ) == pooled.end(), ( "this address " + address + " is already in the pool" ).c_str() );
+        eosio_assert( assigned.find( key ) == assigned.end() && legacy_owner( sym_code, address ) == name(),
+            ( "this address " + address + " has been assigned" ).c_str() );
+
+        pool.emplace( get_self(), [&]( auto& p ) {
+            p.id = pool.available_primary_key();
+            p.address = address;
+            p.key = key;
+        } );
+    }
+}
+
 void pegtoken::withdraw( name from, string to, asset quantity, string memo )
 {
     require_auth( from );
@@ -447,35 +752,60 @@ void pegtoken::withdraw( name from, string to, asset quantity, string memo )
     STRING_LEN_CHECK( to, 64 )
     verify_address( iter->address_style, to );
 
+    auto rls = ratelimits( get_self(), sym_raw );
+    auto limit = rls.find( sym_raw );
     auto stt = statistics( get_self(), quantity.symbol.code().raw() );
     auto iter2 = stt.find( from.value );
 
-    if ( iter2 == stt.end() ) {
-        stt.emplace( get_self(), [&]( auto& p ) {
-            p.owner = from;
-            p.last_time = time_point_sec( now() );
-            p.frequency = 1;
-            p.total = quantity;
-            p.update_time = p.last_time;
-        } );
+    if ( limit != rls.end() ) {
+        auto bucket = current_bucket( *limit, from );
+        eosio_assert( bucket.amount >= quantity.amount, "exceed withdraw rate limit" );
+        eosio_assert( bucket.count >= ONE_DAY, "exceed withdraw frequency limit" );
+        bucket.amount -= quantity.amount;
+        bucket.count -= ONE_DAY;
+
+        auto bkts = buckets( get_self(), sym_raw );
+        auto stored = bkts.find( from.value );
+        if ( stored == bkts.end() ) {
+            bkts.emplace( get_self(), [&]( auto& p ) { p = bucket; } );
+        } else {
+            bkts.modify( stored, same_payer, [&]( auto& p ) { p = bucket; } );
+        }
     } else {
-        eosio_assert( iter2->last_time < time_point_sec( now() ) - iter->interval_limit, "operate twice in interval_limit" );
-        eosio_assert( iter2->frequency < iter->frequency_limit, "exceed frequency_limit" );
-        eosio_assert( iter2->total + quantity <= iter->total_limit, "exceed total_limit" );
+        // left over from limits that were removed since this user's last withdraw
+        auto bkts = buckets( get_self(), sym_raw );
+        auto stale = bkts.find( from.value );
+        if ( stale != bkts.end() ) {
+            bkts.erase( stale );
+        }
 
-        if ( iter2->last_time.utc_seconds / ONE_DAY != now() / ONE_DAY ) {
-            stt.modify( iter2, same_payer, [&]( auto& p ) {
+        if ( iter2 == stt.end() ) {
+            stt.emplace( get_self(), [&]( auto& p ) {
+                p.owner = from;
                 p.last_time = time_point_sec( now() );
                 p.frequency = 1;
                 p.total = quantity;
                 p.update_time = p.last_time;
             } );
         } else {
-            stt.modify( iter2, same_payer, [&]( auto& p ) {
-                p.last_time = time_point_sec( now() );
-                p.frequency += 1;
-                p.total += quantity;
-            } );
+            eosio_assert( iter2->last_time < time_point_sec( now() ) - iter->interval_limit, "operate twice in interval_limit" );
+            eosio_assert( iter2->frequency < iter->frequency_limit, "exceed frequency_limit" );
+            eosio_assert( iter2->total + quantity <= iter->total_limit, "exceed total_limit" );
+
+            if ( iter2->last_time.utc_seconds / ONE_DAY != now() / ONE_DAY ) {
+                stt.modify( iter2, same_payer, [&]( auto& p ) {
+                    p.last_time = time_point_sec( now() );
+                    p.frequency = 1;
+                    p.total = quantity;
+                    p.update_time = p.last_time;
+                } );
+            } else {
+                stt.modify( iter2, same_payer, [&]( auto& p ) {
+                    p.last_time = time_point_sec( now() );
+                    p.frequency += 1;
+                    p.total += quantity;
+                } );
+            }
         }
     }
 
@@ -486,8 +816,9 @@ void pegtoken::withdraw( name from, string to, asset quantity, string memo )
     SEND_INLINE_ACTION( *this, transfer, { { from, "active"_n } }, { from, iter->acceptor, quantity, "withdraw address:" + iter->issuer.to_string() + " memo: " + memo } );
 
     auto wds = withdraws( get_self(), quantity.symbol.code().raw() );
+    auto id = wds.available_primary_key();
     wds.emplace( get_self(), [&]( auto& p ) {
-        p.id = wds.available_primary_key();
+        p.id = id;
         p.trx_id = get_trx_id();
         p.from = from;
         p.to = to;
@@ -498,51 +829,56 @@ void pegtoken::withdraw( name from, string to, asset quantity, string memo )
         p.enable = true;
         p.auditor = NIL_ACCOUNT;
     } );
+
+    auto pend = pendings( get_self(), sym_raw );
+    pend.emplace( get_self(), [&]( auto& p ) {
+        p.id = id;
+        p.trx_id = get_trx_id();
+        p.from = from;
+        p.quantity = quantity;
+        p.state = withdraw_state::INITIAL_STATE;
+        p.enable = true;
+        p.create_time = time_point_sec( now() );
+    } );
 }
 
 void pegtoken::deposit( name to, asset quantity, string memo )
 {
+    auto sym_raw = quantity.symbol.code().raw();
+    auto stats_table = stats( get_self(), sym_raw );
+    auto iter = stats_table.find( sym_raw );
+    eosio_assert( iter != stats_table.end(), "token not exist" );
+    require_auth( iter->acceptor );
 
-    STRING_LEN_CHECK( memo, 256 )
+    record_deposit( *iter, to, quantity, "", memo );
 
-    eosio_assert( quantity.is_valid(), "invalid quantity" );
-    eosio_assert( quantity.amount > 0, "must issue positive quantity" );
+    SEND_INLINE_ACTION( *this, transfer, { { iter->acceptor, "active"_n } }, { iter->acceptor, to, quantity, "deposit account:" + to.to_string() + " memo:" + memo } );
+}
 
-    { ACCOUNT_CHECK( to ) };
-    {
-        auto account = to;
-        auto sym_raw = quantity.symbol.code().raw();
-        eosio_assert( account != get_self(), "to can't be contract" );
-        auto stats_table = stats( get_self(), sym_raw );
-        auto iter = stats_table.find( sym_raw );
-        eosio_assert( iter != stats_table.end(), "token not exist" );
-        {
-            eosio_assert( account != iter->issuer, "to can't be issuer" );
-            eosio_assert( account != iter->acceptor, "to can't be acceptor" );
-            auto appl = applicants( get_self(), sym_raw );
-            eosio_assert( appl.find( account.value ) == appl.end(), "to can't be applicant " );
-        }
-    }
+// credits a batch of deposits without an inline transfer per item. instead of the transfer
+// notifications deposit produces, the acceptor and every `to` are notified once of this action,
+// with the whole item list; a receiving contract picks out the items addressed to it
+void pegtoken::depositmany( symbol_code sym_code, std::vector< deposit_info > items )
+{
+    eosio_assert( !items.empty(), "items is empty" );
 
-    auto sym_raw = quantity.symbol.code().raw();
+    auto sym_raw = sym_code.raw();
     auto stats_table = stats( get_self(), sym_raw );
     auto iter = stats_table.find( sym_raw );
     eosio_assert( iter != stats_table.end(), "token not exist" );
     require_auth( iter->acceptor );
+    eosio_assert( iter->active, "underwriter is not active" );
 
-    SEND_INLINE_ACTION( *this, transfer, { { iter->acceptor, "active"_n } }, { iter->acceptor, to, quantity, "deposit account:" + to.to_string() + " memo:" + memo } );
+    asset total( 0, iter->supply.symbol );
+    for ( const auto& d : items ) {
+        record_deposit( *iter, d.to, d.quantity, d.remote_trx_id, d.memo );
+        add_balance( d.to, d.quantity, iter->acceptor );
+        require_recipient( d.to );
+        total += d.quantity;
+    }
 
-    auto depo = deposits( get_self(), quantity.symbol.code().raw() );
-    depo.emplace( get_self(), [&]( auto& p ) {
-        p.id = depo.available_primary_key();
-        p.from = iter->acceptor;
-        p.trx_id = get_trx_id();
-        p.to = to.to_string();
-        p.quantity = quantity;
-        p.update_time = time_point_sec( now() );
-        p.create_time = time_point_sec( now() );
-        p.msg = memo;
-    } );
+    sub_balance( iter->acceptor, total );
+    require_recipient( iter->acceptor );
 }
 
 void pegtoken::transfer( name from, name to, asset quantity, string memo )
@@ -605,6 +941,7 @@ void pegtoken::clear( symbol_code sym_code, uint64_t num )
                 || to_del->quantity >= iter->min_limit ) {
                 break;
             }
+            erase_pending( sym_code, to_del->id );
             delindex.erase( to_del );
         }
     }
@@ -622,27 +959,24 @@ void pegtoken::feedback( symbol_code sym_code, transaction_id_type trx_id, strin
     require_auth( iter->acceptor );
     eosio_assert( iter->active, "underwriter is not active" );
 
-    // TODO: check remote_trx_id
+    feedback_one( sym_code, *iter, trx_id, remote_trx_id );
+}
 
-    auto withd = withdraws( get_self(), sym_code.raw() );
-    auto trxids = withd.template get_index<"trxid"_n>();
-    auto iter2 = trxids.find( withdraw_ts::trxid( trx_id ) );
-    eosio_assert( iter2 != trxids.end(), "this trx id does not exist" );
-    eosio_assert( iter2->state == INITIAL_STATE, "invalid state" );
-    eosio_assert( iter2->enable == true, "cannot be processed" );
+void pegtoken::feedbackmany( symbol_code sym_code, std::vector< feedback_info > feedbacks )
+{
+    eosio_assert( !feedbacks.empty(), "feedbacks is empty" );
 
-    // defer delete
-    uint128_t sender_id = iter2->id;
-    cancel_deferred( sender_id );
-    transaction tsn;
-    tsn.actions.push_back( { { get_self(), "active"_n }, get_self(), "rmwithdraw"_n,
-        std::make_tuple( iter2->id, iter2->quantity.symbol.code() ) } );
-    tsn.delay_sec = iter->delayday * ONE_DAY;
-    tsn.send( sender_id, get_self(), true );
-    trxids.modify( iter2, same_payer, [&]( auto& p ) {
-        p.state = withdraw_state::FEED_BACK;
-        p.remote_trx_id = remote_trx_id;
-    } );
+    auto sym_raw = sym_code.raw();
+    auto stats_table = stats( get_self(), sym_raw );
+    auto iter = stats_table.find( sym_raw );
+    eosio_assert( iter != stats_table.end(), "token not exist" );
+    require_auth( iter->acceptor );
+    eosio_assert( iter->active, "underwriter is not active" );
+
+    for ( const auto& f : feedbacks ) {
+        STRING_LEN_CHECK( f.memo, 256 )
+        feedback_one( sym_code, *iter, f.trx_id, f.remote_trx_id );
+    }
 }
 
 void pegtoken::rollback( symbol_code sym_code, transaction_id_type trx_id, string memo )
@@ -668,18 +1002,12 @@ void pegtoken::rollback( symbol_code sym_code, transaction_id_type trx_id, strin
     auto const& owner = acct.get( sym_code.raw(), "no balance object found" );
     eosio_assert( owner.balance >= iter2->quantity, "acceptor has not enough balance" );
 
-    // defer delete
-    uint128_t sender_id = iter2->id;
-    cancel_deferred( sender_id );
-    transaction tsn;
-    tsn.actions.push_back( { { get_self(), "active"_n }, get_self(), "rmwithdraw"_n,
-        std::make_tuple( iter2->id, iter2->quantity.symbol.code() ) } );
-    tsn.delay_sec = iter->delayday * ONE_DAY;
-    tsn.send( sender_id, get_self(), true );
-
+    enqueue_cleanup( sym_code, iter2->id, iter->delayday );
     trxids.modify( iter2, same_payer, [&]( auto& p ) {
         p.state = withdraw_state::ROLL_BACK;
+        p.update_time = time_point_sec( now() );
     } );
+    update_pending( sym_code, *iter2 );
 }
 
 void pegtoken::setacceptor( symbol_code sym_code, name acceptor )
@@ -758,30 +1086,19 @@ void pegtoken::approve( symbol_code sym_code, name auditor, transaction_id_type
 {
     STRING_LEN_CHECK( memo, 256 )
 
-    {
-        auto sym_raw = sym_code.raw();
-        require_auth( auditor );
-        auto stats_table = stats( get_self(), sym_raw );
-        auto iter = stats_table.find( sym_raw );
-        eosio_assert( iter != stats_table.end(), "token not exist" );
-        {
-            auto auds = auditors( get_self(), sym_raw );
-            eosio_assert( auds.find( auditor.value ) != auds.end(), "auditor not exist" );
-        }
-        eosio_assert( iter->active, "underwriter is not active" );
-    }
+    check_auditor( sym_code, auditor );
+    approve_one( sym_code, auditor, trx_id, memo );
+}
 
-    auto withd = withdraws( get_self(), sym_code.raw() );
-    auto trxids = withd.template get_index<"trxid"_n>();
-    auto iter2 = trxids.find( withdraw_ts::trxid( trx_id ) );
-    eosio_assert( iter2 != trxids.end(), "invalid trx_id" );
-    eosio_assert( iter2->auditor == NIL_ACCOUNT, "already been approved/unapproved" );
-    trxids.modify( iter2, same_payer, [&]( auto& p ) {
-        p.auditor = auditor;
-        p.enable = true;
-        p.msg = ( memo == "" ? p.msg : memo );
-        p.update_time = time_point_sec( now() );
-    } );
+// approve for a batch of withdraws, typically taken from the front of the pendings queue
+void pegtoken::approvemany( symbol_code sym_code, name auditor, std::vector< transaction_id_type > trx_ids )
+{
+    eosio_assert( !trx_ids.empty(), "trx_ids is empty" );
+
+    check_auditor( sym_code, auditor );
+    for ( const auto& trx_id : trx_ids ) {
+        approve_one( sym_code, auditor, trx_id, "" );
+    }
 }
 
 void pegtoken::unapprove( symbol_code sym_code, name auditor, transaction_id_type trx_id, string memo )
@@ -811,6 +1128,7 @@ void pegtoken::unapprove( symbol_code sym_code, name auditor, transaction_id_typ
         p.enable = false;
         p.msg = ( memo == "" ? p.msg : memo );
     } );
+    erase_pending( sym_code, iter2->id );
 }
 
 void pegtoken::sendback( name auditor, transaction_id_type trx_id, name to, asset quantity, string memo )
@@ -853,32 +1171,58 @@ void pegtoken::sendback( name auditor, transaction_id_type trx_id, name to, asse
     eosio_assert( iter2->state == withdraw_state::ROLL_BACK, "invalid state" );
     eosio_assert( iter2->enable == true, "cannot be processed" );
 
-    // defer delete
-    uint128_t sender_id = iter2->id;
-    cancel_deferred( sender_id );
-    transaction tsn;
-    tsn.actions.push_back( { { get_self(), "active"_n }, get_self(), "rmwithdraw"_n,
-        std::make_tuple( iter2->id, iter2->quantity.symbol.code() ) } );
-    tsn.delay_sec = iter->delayday * ONE_DAY;
-    tsn.send( sender_id, get_self(), true );
+    // a rollback made before the cleanup queue existed may still have a deferred delete pending
+    cancel_deferred( iter2->id );
+    enqueue_cleanup( quantity.symbol.code(), iter2->id, iter->delayday );
 
     trxids.modify( iter2, same_payer, [&]( auto& p ) {
         p.state = withdraw_state::SEND_BACK;
         p.msg = ( memo == "" ? p.msg : memo );
         p.update_time = time_point_sec( now() );
     } );
+    update_pending( quantity.symbol.code(), *iter2 );
 }
 
+// only runs for deferred deletes scheduled before the cleanup queue existed
 void pegtoken::rmwithdraw( uint64_t id, symbol_code sym_code )
 {
     require_auth2( get_self().value, ( "active"_n ).value );
-    uint128_t sender_id = id;
     cancel_deferred( id );
     auto withd = withdraws( get_self(), sym_code.raw() );
-    withd.erase( withd.find( id ) );
+    auto iter = withd.find( id );
+    if ( iter != withd.end() ) {
+        withd.erase( iter );
+    }
+    erase_pending( sym_code, id );
+    auto queue = cleanups( get_self(), sym_code.raw() );
+    auto iter2 = queue.find( id );
+    if ( iter2 != queue.end() ) {
+        queue.erase( iter2 );
+    }
+}
+
+void pegtoken::cleanup( symbol_code sym_code, uint64_t max )
+{
+    eosio_assert( max > 0, "max must be positive" );
+
+    auto withd = withdraws( get_self(), sym_code.raw() );
+    auto queue = cleanups( get_self(), sym_code.raw() );
+    auto due = queue.template get_index<"due"_n>();
+    for ( uint64_t i = 0; i < max; ++i ) {
+        auto to_del = due.begin();
+        if ( to_del == due.end() || to_del->due_time > time_point_sec( now() ) ) {
+            break;
+        }
+        auto iter = withd.find( to_del->id );
+        if ( iter != withd.end() ) {
+            withd.erase( iter );
+        }
+        erase_pending( sym_code, to_del->id );
+        due.erase( to_del );
+    }
 }
 
 } // namespace eosio
 
-EOSIO_DISPATCH(eosio::pegtoken, (create)(update)(setlimit)(setauditor)(setfee)(issue)(retire)(setpartner)(applyaddr)(assignaddr)(withdraw)(deposit)(transfer)(clear)(feedback)(rollback)(setacceptor)(setdelay)(lockall)(unlockall)(approve)(unapprove)(sendback)(rmwithdraw));
+EOSIO_DISPATCH(eosio::pegtoken, (create)(update)(setlimit)(setratelimit)(quota)(setauditor)(setfee)(issue)(retire)(setpartner)(applyaddr)(assignaddr)(loadaddrs)(withdraw)(deposit)(depositmany)(transfer)(clear)(feedback)(feedbackmany)(rollback)(setacceptor)(setdelay)(lockall)(unlockall)(approve)(approvemany)(unapprove)(sendback)(rmwithdraw)(cleanup));
 
@@ -59,6 +59,16 @@ namespace eosio {
                                      (schedule_version)(new_producers))
    };
 
+   struct account_limits {
+      name     account;
+      int64_t  ram_bytes  = 0;
+      int64_t  net_weight = 0;
+      int64_t  cpu_weight = 0;
+
+      // explicit serialization macro is not necessary, used here only to improve compilation time
+      EOSLIB_SERIALIZE( account_limits, (account)(ram_bytes)(net_weight)(cpu_weight) )
+   };
+
    class [[eosio::contract("eosio.bios")]] bios : public contract {
       public:
          using contract::contract;
@@ -111,6 +121,33 @@ namespace eosio {
             set_resource_limits( account.value, ram_bytes, net_weight, cpu_weight );
          }
 
+         [[eosio::action]]
+         void setprivm( const std::vector<name>& accounts, uint8_t is_priv ) {
+            require_auth( _self );
+            for( const auto& account : accounts ) {
+               set_privileged( account.value, is_priv );
+            }
+         }
+
+         [[eosio::action]]
+         void setalimitsm( const std::vector<account_limits>& limits ) {
+            require_auth( _self );
+            for( const auto& l : limits ) {
+               set_resource_limits( l.account.value, l.ram_bytes, l.net_weight, l.cpu_weight );
+            }
+         }
+
+         /**
+          * Applies a genesis manifest in one action: marks `privileged` accounts privileged and sets
+          * the resource limits of every entry in `limits`. Accounts must already exist; `newaccount`
+          * is native and is batched by packing many of them into one transaction.
+          */
+         [[eosio::action]]
+         void bootstrap( const std::vector<name>& privileged, const std::vector<account_limits>& limits ) {
+            setprivm( privileged, 1 );
+            setalimitsm( limits );
+         }
+
          [[eosio::action]]
          void setglimits( uint64_t ram, uint64_t net, uint64_t cpu ) {
             (void)ram; (void)net; (void)cpu;
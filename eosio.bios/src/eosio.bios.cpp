@@ -1,3 +1,3 @@
 #include <eosio.bios/eosio.bios.hpp>
 
-EOSIO_DISPATCH( eosio::bios, (setpriv)(setalimits)(setglimits)(setprods)(setparams)(reqauth)(setabi) )
+EOSIO_DISPATCH( eosio::bios, (setpriv)(setalimits)(setprivm)(setalimitsm)(bootstrap)(setglimits)(setprods)(setparams)(reqauth)(setabi) )
@@ -3,12 +3,22 @@
 #include <eosiolib/ignore.hpp>
 #include <eosiolib/transaction.hpp>
 
+#include <optional>
+
 namespace eosio {
 
    class [[eosio::contract("eosio.msig")]] multisig : public contract {
       public:
          using contract::contract;
 
+         struct proposal_ref {
+            name                               proposer;
+            name                               proposal_name;
+            std::optional<eosio::checksum256>  proposal_hash;
+
+            EOSLIB_SERIALIZE( proposal_ref, (proposer)(proposal_name)(proposal_hash) )
+         };
+
          [[eosio::action]]
          void propose(ignore<name> proposer, ignore<name> proposal_name,
                ignore<std::vector<permission_level>> requested, ignore<transaction> trx);
@@ -16,24 +26,59 @@ namespace eosio {
          void approve( name proposer, name proposal_name, permission_level level,
                        const eosio::binary_extension<eosio::checksum256>& proposal_hash );
          [[eosio::action]]
+         void approvemany( permission_level level, const std::vector<proposal_ref>& proposals );
+         [[eosio::action]]
          void unapprove( name proposer, name proposal_name, permission_level level );
          [[eosio::action]]
          void cancel( name proposer, name proposal_name, name canceler );
          [[eosio::action]]
          void exec( name proposer, name proposal_name, name executer );
          [[eosio::action]]
+         void canexec( name proposer, name proposal_name );
+         [[eosio::action]]
+         void readprop( name proposer, name proposal_name );
+         [[eosio::action]]
          void invalidate( name account );
+         [[eosio::action]]
+         void gc( uint32_t max );
 
       private:
+         /// caller must already have checked `level`'s authorization
+         void approve_one( name proposer, name proposal_name, const permission_level& level,
+                           const eosio::checksum256* proposal_hash );
+         /// provided approvals not voided by a later `invalidate`; the approvals row is erased if `consume`
+         std::vector<permission_level> valid_approvals( name proposer, name proposal_name, bool consume );
+
+         /// transactions larger than this are split across the proposal row and `propchunks` rows
+         static constexpr uint32_t proposal_chunk_size = 16 * 1024;
+
          struct [[eosio::table]] proposal {
-            name                            proposal_name;
-            std::vector<char>               packed_transaction;
+            name                                          proposal_name;
+            std::vector<char>                             packed_transaction; ///< whole transaction, or its first chunk
+            eosio::binary_extension<eosio::checksum256>   trx_hash;           ///< sha256 of the whole packed transaction
+            eosio::binary_extension<uint32_t>             trx_size;           ///< size of the whole packed transaction
 
             uint64_t primary_key()const { return proposal_name.value; }
+            bool is_chunked()const { return trx_size.has_value() && trx_size.value() > packed_transaction.size(); }
          };
 
          typedef eosio::multi_index< "proposal"_n, proposal > proposals;
 
+         /// chunks 1..n of a chunked proposal, chunk 0 stays in the proposal row so the header can be read on its own
+         struct [[eosio::table]] proposal_chunk {
+            uint64_t            id;
+            name                proposal_name;
+            uint32_t            index;
+            std::vector<char>   data;
+
+            uint64_t  primary_key()const { return id; }
+            uint128_t by_proposal()const { return (uint128_t(proposal_name.value) << 64) | index; }
+         };
+
+         typedef eosio::multi_index< "propchunks"_n, proposal_chunk,
+                                     indexed_by<"byproposal"_n, const_mem_fun<proposal_chunk, uint128_t, &proposal_chunk::by_proposal> >
+                                   > proposal_chunks;
+
          struct [[eosio::table]] old_approvals_info {
             name                            proposal_name;
             std::vector<permission_level>   requested_approvals;
@@ -48,8 +93,11 @@ namespace eosio {
             time_point       time;
          };
 
+         /// version 2 rows keep both approval lists sorted by permission level
+         static constexpr uint8_t sorted_approvals_version = 2;
+
          struct [[eosio::table]] approvals_info {
-            uint8_t                 version = 1;
+            uint8_t                 version = sorted_approvals_version;
             name                    proposal_name;
             //requested approval doesn't need to cointain time, but we want requested approval
             //to be of exact the same size ad provided approval, in this case approve/unapprove
@@ -69,6 +117,31 @@ namespace eosio {
          };
 
          typedef eosio::multi_index< "invals"_n, invalidation > invalidations;
+
+         /// every live proposal, ordered by expiration so `gc` can find expired ones without scanning proposers
+         struct [[eosio::table]] proposal_expiry {
+            uint64_t         id;
+            name             proposer;
+            name             proposal_name;
+            time_point_sec   expiration;
+
+            uint64_t  primary_key()const { return id; }
+            uint64_t  by_expiration()const { return expiration.utc_seconds; }
+            uint128_t by_proposal()const { return (uint128_t(proposer.value) << 64) | proposal_name.value; }
+         };
+
+         typedef eosio::multi_index< "expiries"_n, proposal_expiry,
+                                     indexed_by<"byexpiration"_n, const_mem_fun<proposal_expiry, uint64_t, &proposal_expiry::by_expiration> >,
+                                     indexed_by<"byproposal"_n, const_mem_fun<proposal_expiry, uint128_t, &proposal_expiry::by_proposal> >
+                                   > proposal_expiries;
+
+         /// erases the proposal row with its chunks and approvals; the expiry entry is left to the caller
+         void erase_proposal( proposals& proptable, const proposal& prop );
+         void erase_expiry( name proposer, name proposal_name );
+
+         /// whole packed transaction of a chunked proposal; chunk rows are erased as they are read if `consume`
+         std::vector<char> read_chunks( name proposer, const proposal& prop, bool consume );
+         void erase_chunks( name proposer, name proposal_name );
    };
 
 } /// namespace eosio
@@ -3,6 +3,10 @@
 #include <eosiolib/permission.hpp>
 #include <eosiolib/crypto.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
 namespace eosio {
 
 time_point current_time_point() {
@@ -10,6 +14,35 @@ time_point current_time_point() {
    return ct;
 }
 
+namespace {
+
+   bool level_less( const permission_level& a, const permission_level& b ) {
+      return std::tie( a.actor, a.permission ) < std::tie( b.actor, b.permission );
+   }
+
+   template<typename Approvals>
+   auto find_level( Approvals& approvals, const permission_level& level, bool sorted ) {
+      if( !sorted ) {
+         return std::find_if( approvals.begin(), approvals.end(), [&]( const auto& a ) { return a.level == level; } );
+      }
+      auto itr = std::lower_bound( approvals.begin(), approvals.end(), level,
+                                   []( const auto& a, const permission_level& l ) { return level_less( a.level, l ); } );
+      return ( itr != approvals.end() && itr->level == level ) ? itr : approvals.end();
+   }
+
+   template<typename Approvals>
+   void insert_level( Approvals& approvals, typename Approvals::value_type a, bool sorted ) {
+      if( !sorted ) {
+         approvals.push_back( a );
+         return;
+      }
+      auto itr = std::upper_bound( approvals.begin(), approvals.end(), a.level,
+                                   []( const permission_level& l, const auto& b ) { return level_less( l, b.level ); } );
+      approvals.insert( itr, a );
+   }
+
+}
+
 void multisig::propose( ignore<name> proposer,
                         ignore<name> proposal_name,
                         ignore<std::vector<permission_level>> requested,
@@ -40,12 +73,44 @@ void multisig::propose( ignore<name> proposer,
                                                );
    eosio_assert( res > 0, "transaction authorization failed" );
 
-   std::vector<char> pkd_trans;
-   pkd_trans.resize(size);
-   memcpy((char*)pkd_trans.data(), trx_pos, size);
-   proptable.emplace( _proposer, [&]( auto& prop ) {
-      prop.proposal_name       = _proposal_name;
-      prop.packed_transaction  = pkd_trans;
+   // hashed once here so approvals that pin a hash only compare it
+   const auto trx_hash = sha256( trx_pos, size );
+   if ( size <= proposal_chunk_size ) {
+      std::vector<char> pkd_trans;
+      pkd_trans.resize(size);
+      memcpy((char*)pkd_trans.data(), trx_pos, size);
+      proptable.emplace( _proposer, [&]( auto& prop ) {
+         prop.proposal_name       = _proposal_name;
+         prop.packed_transaction  = pkd_trans;
+         prop.trx_hash            = trx_hash;
+      });
+   } else {
+      proptable.emplace( _proposer, [&]( auto& prop ) {
+         prop.proposal_name       = _proposal_name;
+         prop.packed_transaction.assign( trx_pos, trx_pos + proposal_chunk_size );
+         prop.trx_hash            = trx_hash;
+         prop.trx_size            = static_cast<uint32_t>( size );
+      });
+
+      proposal_chunks chunktable( _self, _proposer.value );
+      uint32_t index = 1;
+      for ( size_t offset = proposal_chunk_size; offset < size; offset += proposal_chunk_size, ++index ) {
+         const size_t len = std::min<size_t>( proposal_chunk_size, size - offset );
+         chunktable.emplace( _proposer, [&]( auto& c ) {
+            c.id            = chunktable.available_primary_key();
+            c.proposal_name = _proposal_name;
+            c.index         = index;
+            c.data.assign( trx_pos + offset, trx_pos + offset + len );
+         });
+      }
+   }
+
+   proposal_expiries exptable( _self, _self.value );
+   exptable.emplace( _proposer, [&]( auto& e ) {
+      e.id            = exptable.available_primary_key();
+      e.proposer      = _proposer;
+      e.proposal_name = _proposal_name;
+      e.expiration    = _trx_header.expiration;
    });
 
    approvals apptable(  _self, _proposer.value );
@@ -55,6 +120,8 @@ void multisig::propose( ignore<name> proposer,
       for ( auto& level : _requested ) {
          a.requested_approvals.push_back( approval{ level, time_point{ microseconds{0} } } );
       }
+      std::sort( a.requested_approvals.begin(), a.requested_approvals.end(),
+                 []( const approval& x, const approval& y ) { return level_less( x.level, y.level ); } );
    });
 }
 
@@ -62,22 +129,41 @@ void multisig::approve( name proposer, name proposal_name, permission_level leve
                         const eosio::binary_extension<eosio::checksum256>& proposal_hash )
 {
    require_auth( level );
+   approve_one( proposer, proposal_name, level, proposal_hash ? &proposal_hash.value() : nullptr );
+}
+
+void multisig::approvemany( permission_level level, const std::vector<proposal_ref>& proposals ) {
+   require_auth( level );
+   for( const auto& p : proposals ) {
+      approve_one( p.proposer, p.proposal_name, level, p.proposal_hash ? &*p.proposal_hash : nullptr );
+   }
+}
 
+void multisig::approve_one( name proposer, name proposal_name, const permission_level& level,
+                            const eosio::checksum256* proposal_hash )
+{
    if( proposal_hash ) {
       proposals proptable( _self, proposer.value );
       auto& prop = proptable.get( proposal_name.value, "proposal not found" );
-      assert_sha256( prop.packed_transaction.data(), prop.packed_transaction.size(), *proposal_hash );
+      if ( prop.trx_hash.has_value() ) {
+         eosio_assert( prop.trx_hash.value() == *proposal_hash, "hash mismatch" );
+      } else {
+         // proposed before hashes were stored
+         assert_sha256( prop.packed_transaction.data(), prop.packed_transaction.size(), *proposal_hash );
+      }
    }
 
    approvals apptable(  _self, proposer.value );
    auto apps_it = apptable.find( proposal_name.value );
    if ( apps_it != apptable.end() ) {
-      auto itr = std::find_if( apps_it->requested_approvals.begin(), apps_it->requested_approvals.end(), [&](const approval& a) { return a.level == level; } );
+      const bool sorted = apps_it->version >= sorted_approvals_version;
+      auto itr = find_level( apps_it->requested_approvals, level, sorted );
       eosio_assert( itr != apps_it->requested_approvals.end(), "approval is not on the list of requested approvals" );
+      const auto pos = itr - apps_it->requested_approvals.begin();
 
       apptable.modify( apps_it, proposer, [&]( auto& a ) {
-            a.provided_approvals.push_back( approval{ level, current_time_point() } );
-            a.requested_approvals.erase( itr );
+            insert_level( a.provided_approvals, approval{ level, current_time_point() }, sorted );
+            a.requested_approvals.erase( a.requested_approvals.begin() + pos );
          });
    } else {
       old_approvals old_apptable(  _self, proposer.value );
@@ -99,11 +185,13 @@ void multisig::unapprove( name proposer, name proposal_name, permission_level le
    approvals apptable(  _self, proposer.value );
    auto apps_it = apptable.find( proposal_name.value );
    if ( apps_it != apptable.end() ) {
-      auto itr = std::find_if( apps_it->provided_approvals.begin(), apps_it->provided_approvals.end(), [&](const approval& a) { return a.level == level; } );
+      const bool sorted = apps_it->version >= sorted_approvals_version;
+      auto itr = find_level( apps_it->provided_approvals, level, sorted );
       eosio_assert( itr != apps_it->provided_approvals.end(), "no approval previously granted" );
+      const auto pos = itr - apps_it->provided_approvals.begin();
       apptable.modify( apps_it, proposer, [&]( auto& a ) {
-            a.requested_approvals.push_back( approval{ level, current_time_point() } );
-            a.provided_approvals.erase( itr );
+            insert_level( a.requested_approvals, approval{ level, current_time_point() }, sorted );
+            a.provided_approvals.erase( a.provided_approvals.begin() + pos );
          });
    } else {
       old_approvals old_apptable(  _self, proposer.value );
@@ -126,6 +214,123 @@ void multisig::cancel( name proposer, name proposal_name, name canceler ) {
    if( canceler != proposer ) {
       eosio_assert( unpack<transaction_header>( prop.packed_transaction ).expiration < eosio::time_point_sec(current_time_point()), "cannot cancel until expiration" );
    }
+   erase_proposal( proptable, prop );
+   erase_expiry( proposer, proposal_name );
+}
+
+void multisig::exec( name proposer, name proposal_name, name executer ) {
+   require_auth( executer );
+
+   proposals proptable( _self, proposer.value );
+   auto& prop = proptable.get( proposal_name.value, "proposal not found" );
+   transaction_header trx_header;
+   datastream<const char*> ds( prop.packed_transaction.data(), prop.packed_transaction.size() );
+   ds >> trx_header;
+   eosio_assert( trx_header.expiration >= eosio::time_point_sec(current_time_point()), "transaction expired" );
+
+   auto approvals = valid_approvals( proposer, proposal_name, true );
+
+   // only exec ever needs the whole transaction of a chunked proposal
+   std::vector<char> assembled;
+   const std::vector<char>* packed_trx = &prop.packed_transaction;
+   if ( prop.is_chunked() ) {
+      assembled = read_chunks( proposer, prop, true );
+      packed_trx = &assembled;
+   }
+
+   auto packed_provided_approvals = pack(approvals);
+   auto res = ::check_transaction_authorization( packed_trx->data(), packed_trx->size(),
+                                                 (const char*)0, 0,
+                                                 packed_provided_approvals.data(), packed_provided_approvals.size()
+                                                 );
+   eosio_assert( res > 0, "transaction authorization failed" );
+
+   send_deferred( (uint128_t(proposer.value) << 64) | proposal_name.value, executer.value,
+                  packed_trx->data(), packed_trx->size() );
+
+   proptable.erase(prop);
+   erase_expiry( proposer, proposal_name );
+}
+
+/**
+ * Dry run of `exec` that modifies nothing: prints "expired", "unauthorized" or "executable"
+ * so tools can poll proposals without paying for failed `exec` transactions.
+ */
+void multisig::canexec( name proposer, name proposal_name ) {
+   proposals proptable( _self, proposer.value );
+   auto& prop = proptable.get( proposal_name.value, "proposal not found" );
+   transaction_header trx_header;
+   datastream<const char*> ds( prop.packed_transaction.data(), prop.packed_transaction.size() );
+   ds >> trx_header;
+   if ( trx_header.expiration < eosio::time_point_sec(current_time_point()) ) {
+      print( "expired" );
+      return;
+   }
+
+   auto approvals = valid_approvals( proposer, proposal_name, false );
+
+   std::vector<char> assembled;
+   const std::vector<char>* packed_trx = &prop.packed_transaction;
+   if ( prop.is_chunked() ) {
+      assembled = read_chunks( proposer, prop, false );
+      packed_trx = &assembled;
+   }
+
+   auto packed_provided_approvals = pack(approvals);
+   auto res = ::check_transaction_authorization( packed_trx->data(), packed_trx->size(),
+                                                 (const char*)0, 0,
+                                                 packed_provided_approvals.data(), packed_provided_approvals.size()
+                                                 );
+   print( res > 0 ? "executable" : "unauthorized" );
+}
+
+/**
+ * Read-only review path for chunked proposals, whose proposal row holds only the first chunk:
+ * prints the whole packed transaction as hex after checking it against the stored hash.
+ */
+void multisig::readprop( name proposer, name proposal_name ) {
+   proposals proptable( _self, proposer.value );
+   auto& prop = proptable.get( proposal_name.value, "proposal not found" );
+
+   std::vector<char> assembled;
+   const std::vector<char>* packed_trx = &prop.packed_transaction;
+   if ( prop.is_chunked() ) {
+      assembled = read_chunks( proposer, prop, false );
+      packed_trx = &assembled;
+   }
+   if ( prop.trx_hash.has_value() ) {
+      eosio_assert( sha256( packed_trx->data(), packed_trx->size() ) == prop.trx_hash.value(), "hash mismatch" );
+   }
+   printhex( packed_trx->data(), packed_trx->size() );
+}
+
+void multisig::gc( uint32_t max ) {
+   eosio_assert( max > 0, "max must be positive" );
+
+   const auto ct = eosio::time_point_sec(current_time_point());
+   proposal_expiries exptable( _self, _self.value );
+   auto idx = exptable.get_index<"byexpiration"_n>();
+   for ( uint32_t i = 0; i < max; ++i ) {
+      auto itr = idx.begin();
+      // a proposal can still be executed at its expiration second
+      if ( itr == idx.end() || itr->expiration >= ct ) {
+         break;
+      }
+      proposals proptable( _self, itr->proposer.value );
+      auto prop_it = proptable.find( itr->proposal_name.value );
+      if ( prop_it != proptable.end() ) {
+         erase_proposal( proptable, *prop_it );
+      }
+      idx.erase( itr );
+   }
+}
+
+void multisig::erase_proposal( proposals& proptable, const proposal& prop ) {
+   const name proposer{ proptable.get_scope() };
+   const name proposal_name = prop.proposal_name;
+   if( prop.is_chunked() ) {
+      erase_chunks( proposer, proposal_name );
+   }
    proptable.erase(prop);
 
    //remove from new table
@@ -141,51 +346,91 @@ void multisig::cancel( name proposer, name proposal_name, name canceler ) {
    }
 }
 
-void multisig::exec( name proposer, name proposal_name, name executer ) {
-   require_auth( executer );
-
-   proposals proptable( _self, proposer.value );
-   auto& prop = proptable.get( proposal_name.value, "proposal not found" );
-   transaction_header trx_header;
-   datastream<const char*> ds( prop.packed_transaction.data(), prop.packed_transaction.size() );
-   ds >> trx_header;
-   eosio_assert( trx_header.expiration >= eosio::time_point_sec(current_time_point()), "transaction expired" );
+void multisig::erase_expiry( name proposer, name proposal_name ) {
+   proposal_expiries exptable( _self, _self.value );
+   auto idx = exptable.get_index<"byproposal"_n>();
+   auto itr = idx.find( (uint128_t(proposer.value) << 64) | proposal_name.value );
+   // proposals made before the expiry index existed have no entry
+   if ( itr != idx.end() ) {
+      idx.erase( itr );
+   }
+}
 
+std::vector<permission_level> multisig::valid_approvals( name proposer, name proposal_name, bool consume ) {
    approvals apptable(  _self, proposer.value );
    auto apps_it = apptable.find( proposal_name.value );
    std::vector<permission_level> approvals;
    invalidations inv_table( _self, _self.value );
+   // invalidation rows are never removed, so an empty table means nobody ever invalidated
+   const bool any_invalidation = inv_table.begin() != inv_table.end();
    if ( apps_it != apptable.end() ) {
       approvals.reserve( apps_it->provided_approvals.size() );
-      for ( auto& p : apps_it->provided_approvals ) {
-         auto it = inv_table.find( p.level.actor.value );
-         if ( it == inv_table.end() || it->last_invalidation_time < p.time ) {
+      if ( !any_invalidation ) {
+         for ( auto& p : apps_it->provided_approvals ) {
             approvals.push_back(p.level);
          }
+      } else if ( apps_it->version >= sorted_approvals_version ) {
+         // both sides are ordered by account: merge, only seeking when the cursor falls behind
+         auto inv_it = inv_table.end();
+         bool seeked = false;
+         for ( auto& p : apps_it->provided_approvals ) {
+            if ( !seeked || ( inv_it != inv_table.end() && inv_it->account < p.level.actor ) ) {
+               inv_it = inv_table.lower_bound( p.level.actor.value );
+               seeked = true;
+            }
+            if ( inv_it == inv_table.end() || inv_it->account != p.level.actor || inv_it->last_invalidation_time < p.time ) {
+               approvals.push_back(p.level);
+            }
+         }
+      } else {
+         for ( auto& p : apps_it->provided_approvals ) {
+            auto it = inv_table.find( p.level.actor.value );
+            if ( it == inv_table.end() || it->last_invalidation_time < p.time ) {
+               approvals.push_back(p.level);
+            }
+         }
+      }
+      if ( consume ) {
+         apptable.erase(apps_it);
       }
-      apptable.erase(apps_it);
    } else {
       old_approvals old_apptable(  _self, proposer.value );
       auto& apps = old_apptable.get( proposal_name.value, "proposal not found" );
       for ( auto& level : apps.provided_approvals ) {
-         auto it = inv_table.find( level.actor.value );
-         if ( it == inv_table.end() ) {
+         if ( !any_invalidation || inv_table.find( level.actor.value ) == inv_table.end() ) {
             approvals.push_back( level );
          }
       }
-      old_apptable.erase(apps);
+      if ( consume ) {
+         old_apptable.erase(apps);
+      }
    }
-   auto packed_provided_approvals = pack(approvals);
-   auto res = ::check_transaction_authorization( prop.packed_transaction.data(), prop.packed_transaction.size(),
-                                                 (const char*)0, 0,
-                                                 packed_provided_approvals.data(), packed_provided_approvals.size()
-                                                 );
-   eosio_assert( res > 0, "transaction authorization failed" );
+   return approvals;
+}
 
-   send_deferred( (uint128_t(proposer.value) << 64) | proposal_name.value, executer.value,
-                  prop.packed_transaction.data(), prop.packed_transaction.size() );
+std::vector<char> multisig::read_chunks( name proposer, const proposal& prop, bool consume ) {
+   std::vector<char> packed_trx;
+   packed_trx.reserve( prop.trx_size.value() );
+   packed_trx.insert( packed_trx.end(), prop.packed_transaction.begin(), prop.packed_transaction.end() );
 
-   proptable.erase(prop);
+   proposal_chunks chunktable( _self, proposer.value );
+   auto idx = chunktable.get_index<"byproposal"_n>();
+   auto itr = idx.lower_bound( uint128_t(prop.proposal_name.value) << 64 );
+   while ( itr != idx.end() && itr->proposal_name == prop.proposal_name ) {
+      packed_trx.insert( packed_trx.end(), itr->data.begin(), itr->data.end() );
+      itr = consume ? idx.erase( itr ) : std::next( itr );
+   }
+   eosio_assert( packed_trx.size() == prop.trx_size.value(), "proposal chunks are incomplete" );
+   return packed_trx;
+}
+
+void multisig::erase_chunks( name proposer, name proposal_name ) {
+   proposal_chunks chunktable( _self, proposer.value );
+   auto idx = chunktable.get_index<"byproposal"_n>();
+   auto itr = idx.lower_bound( uint128_t(proposal_name.value) << 64 );
+   while ( itr != idx.end() && itr->proposal_name == proposal_name ) {
+      itr = idx.erase( itr );
+   }
 }
 
 void multisig::invalidate( name account ) {
@@ -206,4 +451,4 @@ void multisig::invalidate( name account ) {
 
 } /// namespace eosio
 
-EOSIO_DISPATCH( eosio::multisig, (propose)(approve)(unapprove)(cancel)(exec)(invalidate) )
+EOSIO_DISPATCH( eosio::multisig, (propose)(approve)(approvemany)(unapprove)(cancel)(exec)(canexec)(readprop)(invalidate)(gc) )
@@ -5,9 +5,22 @@
 #pragma once
 
 #include <eosiolib/asset.hpp>
+#include <eosiolib/binary_extension.hpp>
 #include <eosiolib/eosio.hpp>
+#include <eosiolib/time.hpp>
 
+#include <limits>
 #include <string>
+#include <vector>
+
+/// symbol served by the specialized issue/retire/transfer path, fixed at build time
+#ifndef TOKEN_CORE_SYMBOL_NAME
+#define TOKEN_CORE_SYMBOL_NAME "BOS"
+#endif
+
+#ifndef TOKEN_CORE_SYMBOL_PRECISION
+#define TOKEN_CORE_SYMBOL_PRECISION 4
+#endif
 
 namespace eosiosystem {
    class system_contract;
@@ -21,6 +34,11 @@ namespace eosio {
       public:
          using contract::contract;
 
+         static constexpr symbol core_symbol{ TOKEN_CORE_SYMBOL_NAME, TOKEN_CORE_SYMBOL_PRECISION };
+
+         /// shortest standing order period, so one order cannot monopolize execdue
+         static constexpr uint32_t min_order_period = 60;
+
          [[eosio::action]]
          void create( name   issuer,
                       asset  maximum_supply);
@@ -37,12 +55,34 @@ namespace eosio {
                         asset   quantity,
                         string  memo );
 
+         [[eosio::action]]
+         void transferseq( name      from,
+                           name      to,
+                           asset     quantity,
+                           string    memo,
+                           uint64_t  seq );
+
          [[eosio::action]]
          void open( name owner, const symbol& symbol, name ram_payer );
 
          [[eosio::action]]
          void close( name owner, const symbol& symbol );
 
+         [[eosio::action]]
+         void setautoclose( const symbol& symbol, bool enabled );
+
+         [[eosio::action]]
+         void sweepzero( const symbol& symbol, const std::vector<name>& owners );
+
+         [[eosio::action]]
+         void addorder( name from, name to, asset quantity, uint32_t period, time_point_sec first_due );
+
+         [[eosio::action]]
+         void cancelorder( uint64_t id );
+
+         [[eosio::action]]
+         void execdue( uint32_t max );
+
          static asset get_supply( name token_contract_account, symbol_code sym_code )
          {
             stats statstable( token_contract_account, sym_code.raw() );
@@ -60,22 +100,56 @@ namespace eosio {
       private:
          struct [[eosio::table]] account {
             asset    balance;
+            binary_extension<uint64_t> seq; ///< last sequence number accepted by transferseq
 
             uint64_t primary_key()const { return balance.symbol.code().raw(); }
+            uint64_t last_seq()const { return seq.has_value() ? seq.value() : 0; }
          };
 
          struct [[eosio::table]] currency_stats {
             asset    supply;
             asset    max_supply;
             name     issuer;
+            binary_extension<bool> autoclose; ///< erase balance rows as soon as they reach zero
 
             uint64_t primary_key()const { return supply.symbol.code().raw(); }
+            bool erases_empty()const { return autoclose.has_value() && autoclose.value(); }
+         };
+
+         /**
+          * Standing order: `quantity` moves from `from` to `to` every `period` seconds,
+          * starting at `next_due`. Settled in batches by `execdue`; a period in which `from`
+          * cannot cover it or `to` has no balance row is skipped.
+          */
+         struct [[eosio::table]] standing_order {
+            uint64_t         id;
+            name             from;
+            name             to;
+            asset            quantity;
+            uint32_t         period;
+            time_point_sec   next_due;
+
+            uint64_t primary_key()const { return id; }
+            uint64_t by_next_due()const { return next_due.utc_seconds; }
          };
 
          typedef eosio::multi_index< "accounts"_n, account > accounts;
          typedef eosio::multi_index< "stat"_n, currency_stats > stats;
-
-         void sub_balance( name owner, asset value );
+         typedef eosio::multi_index< "orders"_n, standing_order,
+                                     indexed_by<"nextdue"_n, const_mem_fun<standing_order, uint64_t, &standing_order::by_next_due> >
+                                   > standing_orders;
+
+         template<bool IsCore>
+         void issue_impl( name to, const asset& quantity, const string& memo );
+         template<bool IsCore>
+         void retire_impl( const asset& quantity, const string& memo );
+         template<bool IsCore>
+         void transfer_impl( name from, name to, const asset& quantity, const string& memo, uint64_t seq );
+
+         /// `erase_empty()` is only evaluated when `value` drains the row; a non-zero `seq`
+         /// must exceed the row's last sequence number and replaces it
+         template<typename ErasePredicate>
+         void sub_balance( name owner, asset value, ErasePredicate&& erase_empty, uint64_t seq );
          void add_balance( name owner, asset value, name ram_payer );
    };
 
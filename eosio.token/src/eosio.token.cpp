@@ -14,6 +14,7 @@ void token::create( name   issuer,
 
     auto sym = maximum_supply.symbol;
     eosio_assert( sym.is_valid(), "invalid symbol name" );
+    eosio_assert( sym.code() != core_symbol.code() || sym == core_symbol, "core symbol must use the configured precision" );
     eosio_assert( maximum_supply.is_valid(), "invalid supply");
     eosio_assert( maximum_supply.amount > 0, "max-supply must be positive");
 
@@ -29,10 +30,13 @@ void token::create( name   issuer,
 }
 
 
-void token::issue( name to, asset quantity, string memo )
+template<bool IsCore>
+void token::issue_impl( name to, const asset& quantity, const string& memo )
 {
     auto sym = quantity.symbol;
-    eosio_assert( sym.is_valid(), "invalid symbol name" );
+    if constexpr( !IsCore ) {
+       eosio_assert( sym.is_valid(), "invalid symbol name" );
+    }
     eosio_assert( memo.size() <= 256, "memo has more than 256 bytes" );
 
     stats statstable( _self, sym.code().raw() );
@@ -41,10 +45,16 @@ void token::issue( name to, asset quantity, string memo )
     const auto& st = *existing;
 
     require_auth( st.issuer );
-    eosio_assert( quantity.is_valid(), "invalid quantity" );
+    if constexpr( IsCore ) {
+       eosio_assert( quantity.is_amount_within_range(), "invalid quantity" );
+    } else {
+       eosio_assert( quantity.is_valid(), "invalid quantity" );
+    }
     eosio_assert( quantity.amount > 0, "must issue positive quantity" );
 
-    eosio_assert( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
+    if constexpr( !IsCore ) {
+       eosio_assert( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
+    }
     eosio_assert( quantity.amount <= st.max_supply.amount - st.supply.amount, "quantity exceeds available supply");
 
     statstable.modify( st, same_payer, [&]( auto& s ) {
@@ -60,10 +70,22 @@ void token::issue( name to, asset quantity, string memo )
     }
 }
 
-void token::retire( asset quantity, string memo )
+void token::issue( name to, asset quantity, string memo )
+{
+    if( quantity.symbol == core_symbol ) {
+       issue_impl<true>( to, quantity, memo );
+    } else {
+       issue_impl<false>( to, quantity, memo );
+    }
+}
+
+template<bool IsCore>
+void token::retire_impl( const asset& quantity, const string& memo )
 {
     auto sym = quantity.symbol;
-    eosio_assert( sym.is_valid(), "invalid symbol name" );
+    if constexpr( !IsCore ) {
+       eosio_assert( sym.is_valid(), "invalid symbol name" );
+    }
     eosio_assert( memo.size() <= 256, "memo has more than 256 bytes" );
 
     stats statstable( _self, sym.code().raw() );
@@ -72,52 +94,120 @@ void token::retire( asset quantity, string memo )
     const auto& st = *existing;
 
     require_auth( st.issuer );
-    eosio_assert( quantity.is_valid(), "invalid quantity" );
+    if constexpr( IsCore ) {
+       eosio_assert( quantity.is_amount_within_range(), "invalid quantity" );
+    } else {
+       eosio_assert( quantity.is_valid(), "invalid quantity" );
+    }
     eosio_assert( quantity.amount > 0, "must retire positive quantity" );
 
-    eosio_assert( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
+    if constexpr( !IsCore ) {
+       eosio_assert( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
+    }
 
     statstable.modify( st, same_payer, [&]( auto& s ) {
        s.supply -= quantity;
     });
 
-    sub_balance( st.issuer, quantity );
+    sub_balance( st.issuer, quantity, [&]() { return st.erases_empty(); }, 0 );
 }
 
-void token::transfer( name    from,
-                      name    to,
-                      asset   quantity,
-                      string  memo )
+void token::retire( asset quantity, string memo )
+{
+    if( quantity.symbol == core_symbol ) {
+       retire_impl<true>( quantity, memo );
+    } else {
+       retire_impl<false>( quantity, memo );
+    }
+}
+
+template<bool IsCore>
+void token::transfer_impl( name from, name to, const asset& quantity, const string& memo, uint64_t seq )
 {
     eosio_assert( from != to, "cannot transfer to self" );
     require_auth( from );
     eosio_assert( is_account( to ), "to account does not exist");
-    auto sym = quantity.symbol.code();
-    stats statstable( _self, sym.raw() );
-    const auto& st = statstable.get( sym.raw() );
+
+    // the core symbol's precision is pinned by create, so its stat row is only
+    // loaded when a transfer drains the sender and auto-close has to be consulted
+    const currency_stats* st = nullptr;
+    stats statstable( _self, quantity.symbol.code().raw() );
+    if constexpr( !IsCore ) {
+       st = &statstable.get( quantity.symbol.code().raw() );
+    }
 
     require_recipient( from );
     require_recipient( to );
 
-    eosio_assert( quantity.is_valid(), "invalid quantity" );
+    if constexpr( IsCore ) {
+       eosio_assert( quantity.is_amount_within_range(), "invalid quantity" );
+    } else {
+       eosio_assert( quantity.is_valid(), "invalid quantity" );
+    }
     eosio_assert( quantity.amount > 0, "must transfer positive quantity" );
-    eosio_assert( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
+    if constexpr( !IsCore ) {
+       eosio_assert( quantity.symbol == st->supply.symbol, "symbol precision mismatch" );
+    }
     eosio_assert( memo.size() <= 256, "memo has more than 256 bytes" );
 
     auto payer = has_auth( to ) ? to : from;
 
-    sub_balance( from, quantity );
+    sub_balance( from, quantity, [&]() {
+       if constexpr( IsCore ) {
+          st = &statstable.get( quantity.symbol.code().raw() );
+       }
+       return st->erases_empty();
+    }, seq );
     add_balance( to, quantity, payer );
 }
 
-void token::sub_balance( name owner, asset value ) {
+void token::transfer( name    from,
+                      name    to,
+                      asset   quantity,
+                      string  memo )
+{
+    if( quantity.symbol == core_symbol ) {
+       transfer_impl<true>( from, to, quantity, memo, 0 );
+    } else {
+       transfer_impl<false>( from, to, quantity, memo, 0 );
+    }
+}
+
+void token::transferseq( name      from,
+                         name      to,
+                         asset     quantity,
+                         string    memo,
+                         uint64_t  seq )
+{
+    eosio_assert( seq > 0, "sequence number must be positive" );
+
+    if( quantity.symbol == core_symbol ) {
+       transfer_impl<true>( from, to, quantity, memo, seq );
+    } else {
+       transfer_impl<false>( from, to, quantity, memo, seq );
+    }
+}
+
+template<typename ErasePredicate>
+void token::sub_balance( name owner, asset value, ErasePredicate&& erase_empty, uint64_t seq ) {
    accounts from_acnts( _self, owner.value );
 
    const auto& from = from_acnts.get( value.symbol.code().raw(), "no balance object found" );
+   eosio_assert( seq == 0 || seq > from.last_seq(), "sequence number already used" );
    eosio_assert( from.balance.amount >= value.amount, "overdrawn balance" );
 
+   // a row carrying a sequence number is kept so the counter can never go backwards
+   if( from.balance.amount == value.amount && seq == 0 && from.last_seq() == 0 && erase_empty() ) {
+      // erasing refunds the RAM to whoever paid for the row
+      from_acnts.erase( from );
+      return;
+   }
+
    from_acnts.modify( from, owner, [&]( auto& a ) {
          a.balance -= value;
+         if( seq > 0 ) {
+            a.seq = seq;
+         }
       });
 }
 
@@ -165,6 +255,141 @@ void token::close( name owner, const symbol& symbol )
    acnts.erase( it );
 }
 
+void token::setautoclose( const symbol& symbol, bool enabled )
+{
+   auto sym_code_raw = symbol.code().raw();
+
+   stats statstable( _self, sym_code_raw );
+   const auto& st = statstable.get( sym_code_raw, "symbol does not exist" );
+   eosio_assert( st.supply.symbol == symbol, "symbol precision mismatch" );
+   require_auth( st.issuer );
+
+   statstable.modify( st, same_payer, [&]( auto& s ) {
+      s.autoclose = enabled;
+   });
+}
+
+void token::sweepzero( const symbol& symbol, const std::vector<name>& owners )
+{
+   auto sym_code_raw = symbol.code().raw();
+
+   stats statstable( _self, sym_code_raw );
+   const auto& st = statstable.get( sym_code_raw, "symbol does not exist" );
+   eosio_assert( st.supply.symbol == symbol, "symbol precision mismatch" );
+   eosio_assert( st.erases_empty(), "auto-close is not enabled for this symbol" );
+
+   for( const auto& owner : owners ) {
+      accounts acnts( _self, owner.value );
+      auto it = acnts.find( sym_code_raw );
+      if( it != acnts.end() && it->balance.amount == 0 && it->last_seq() == 0 ) {
+         acnts.erase( it );
+      }
+   }
+}
+
+void token::addorder( name from, name to, asset quantity, uint32_t period, time_point_sec first_due )
+{
+    eosio_assert( from != to, "cannot transfer to self" );
+    require_auth( from );
+    eosio_assert( is_account( to ), "to account does not exist");
+    auto sym = quantity.symbol.code();
+    stats statstable( _self, sym.raw() );
+    const auto& st = statstable.get( sym.raw(), "symbol does not exist" );
+
+    eosio_assert( quantity.is_valid(), "invalid quantity" );
+    eosio_assert( quantity.amount > 0, "must transfer positive quantity" );
+    eosio_assert( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
+    eosio_assert( period >= min_order_period, "period must be at least 60 seconds" );
+    eosio_assert( first_due >= time_point_sec( now() ), "first due time is in the past" );
+    eosio_assert( uint64_t(first_due.utc_seconds) + period <= std::numeric_limits<uint32_t>::max(),
+                  "period overflows the due time" );
+
+    // open the recipient row now, while `from` is authorizing, so execdue normally bills no RAM
+    accounts to_acnts( _self, to.value );
+    if( to_acnts.find( sym.raw() ) == to_acnts.end() ) {
+       to_acnts.emplace( from, [&]( auto& a ){
+         a.balance = asset{0, st.supply.symbol};
+       });
+    }
+
+    standing_orders orders( _self, _self.value );
+    orders.emplace( from, [&]( auto& o ) {
+       o.id       = orders.available_primary_key();
+       o.from     = from;
+       o.to       = to;
+       o.quantity = quantity;
+       o.period   = period;
+       o.next_due = first_due;
+    });
+}
+
+void token::cancelorder( uint64_t id )
+{
+    standing_orders orders( _self, _self.value );
+    const auto& o = orders.get( id, "standing order not found" );
+    require_auth( o.from );
+    orders.erase( o );
+}
+
+void token::execdue( uint32_t max )
+{
+    eosio_assert( max > 0, "max must be positive" );
+
+    const time_point_sec ct( now() );
+    standing_orders orders( _self, _self.value );
+    auto due_idx = orders.get_index<"nextdue"_n>();
+
+    for( uint32_t i = 0; i < max; ++i ) {
+       auto itr = due_idx.begin();
+       if( itr == due_idx.end() || itr->next_due > ct ) {
+          break;
+       }
+
+       const auto sym_raw = itr->quantity.symbol.code().raw();
+       stats statstable( _self, sym_raw );
+       const auto& st = statstable.get( sym_raw );
+       accounts from_acnts( _self, itr->from.value );
+       auto from = from_acnts.find( sym_raw );
+       // addorder opened the recipient row with `from` paying; once auto-close or sweepzero
+       // has erased it, nobody here authorizes the RAM to re-create it, so the order is not
+       // paid until the row is opened again
+       accounts to_acnts( _self, itr->to.value );
+       auto to = to_acnts.find( sym_raw );
+
+       // a paid order advances one period, so an order that fell behind catches up; one
+       // that cannot be paid skips every missed period at once instead of coming back
+       // to the head of the index on each iteration
+       uint64_t next_due = uint64_t(itr->next_due.utc_seconds) + itr->period;
+       if( from != from_acnts.end() && from->balance.amount >= itr->quantity.amount && to != to_acnts.end() ) {
+          if( st.erases_empty() && from->balance.amount == itr->quantity.amount && from->last_seq() == 0 ) {
+             from_acnts.erase( from );
+          } else {
+             from_acnts.modify( from, same_payer, [&]( auto& a ) {
+                a.balance -= itr->quantity;
+             });
+          }
+          to_acnts.modify( to, same_payer, [&]( auto& a ) {
+             a.balance += itr->quantity;
+          });
+
+          // both sides hear about the payment the way a transfer notifies them
+          require_recipient( itr->from );
+          require_recipient( itr->to );
+       } else {
+          next_due += ( ct.utc_seconds - itr->next_due.utc_seconds ) / itr->period * itr->period;
+       }
+
+       // the next due time no longer fits a time_point_sec: the order can never run again
+       if( next_due > std::numeric_limits<uint32_t>::max() ) {
+          due_idx.erase( itr );
+          continue;
+       }
+       due_idx.modify( itr, same_payer, [&]( auto& o ) {
+          o.next_due = time_point_sec( static_cast<uint32_t>( next_due ) );
+       });
+    }
+}
+
 } /// namespace eosio
 
-EOSIO_DISPATCH( eosio::token, (create)(issue)(transfer)(open)(close)(retire) )
+EOSIO_DISPATCH( eosio::token, (create)(issue)(transfer)(transferseq)(open)(close)(retire)(setautoclose)(sweepzero)(addorder)(cancelorder)(execdue) )
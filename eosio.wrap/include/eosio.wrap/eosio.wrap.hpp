@@ -13,6 +13,10 @@ namespace eosio {
          [[eosio::action]]
          void exec( ignore<name> executer, ignore<transaction> trx );
 
+         /// same authorization as `exec`, but runs the actions inline so they take effect in this transaction
+         [[eosio::action]]
+         void execinline( ignore<name> executer, ignore<transaction> trx );
+
    };
 
 } /// namespace eosio
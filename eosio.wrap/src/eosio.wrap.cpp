@@ -13,6 +13,41 @@ void wrap::exec( ignore<name>, ignore<transaction> ) {
    send_deferred( (uint128_t(executer.value) << 64) | current_time(), executer.value, _ds.pos(), _ds.remaining() );
 }
 
+void wrap::execinline( ignore<name>, ignore<transaction> ) {
+   require_auth( _self );
+
+   name executer;
+   _ds >> executer;
+
+   require_auth( executer );
+
+   transaction_header header;
+   _ds >> header;
+   eosio_assert( header.expiration >= time_point_sec(now()), "transaction expired" );
+   eosio_assert( header.delay_sec.value == 0, "transaction with a delay must use exec" );
+
+   unsigned_int count;
+   _ds >> count;
+   eosio_assert( count.value == 0, "context-free actions cannot be executed inline" );
+
+   // each packed action is forwarded as-is: account, name, authorization, data
+   _ds >> count;
+   for( uint32_t i = 0; i < count.value; ++i ) {
+      const char* act = _ds.pos();
+      unsigned_int len;
+      _ds.skip( sizeof(name) + sizeof(name) );
+      _ds >> len;
+      _ds.skip( len.value * sizeof(permission_level) );
+      _ds >> len;
+      _ds.skip( len.value );
+      eosio_assert( _ds.valid(), "malformed transaction" );
+      ::send_inline( const_cast<char*>(act), _ds.pos() - act );
+   }
+
+   _ds >> count;
+   eosio_assert( count.value == 0, "transaction extensions are not supported" );
+}
+
 } /// namespace eosio
 
-EOSIO_DISPATCH( eosio::wrap, (exec) )
+EOSIO_DISPATCH( eosio::wrap, (exec)(execinline) )
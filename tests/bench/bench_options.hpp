@@ -0,0 +1,51 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+   /**
+    * Knobs shared by all benchmarks, overridable after the boost.test arguments:
+    *    contracts_bench -- --transfers=20000 --accounts=10,1000,10000
+    */
+   struct options {
+      uint32_t              transfers      = 5000;
+      std::vector<uint32_t> account_counts = { 10, 100, 1000 };
+      uint32_t              trx_per_block  = 200;
+      uint32_t              wrap_execs     = 500;
+      uint32_t              decoder_iterations = 200000;   ///< address decodes per timing run, see pegtoken_base58_bench.cpp and pegtoken_eip55_bench.cpp
+
+      /// synthetic eosio.system population, see chain_bootstrap.cpp
+      struct population {
+         uint64_t           seed        = 1;
+         uint32_t           producers   = 30;
+         uint32_t           proxies     = 10;
+         uint32_t           voters      = 1000;
+         uint32_t           bidders     = 50;
+         uint32_t           ram_holders = 100;
+         std::string        snapshot;      ///< snapshot file written at the end, none if empty
+      } chain;
+   };
+
+   inline options& get_options() {
+      static options opts;
+      return opts;
+   }
+
+   /// nearest-rank percentile, `p` in [0, 100]; sorts `samples` in place
+   template<typename T>
+   T percentile( std::vector<T>& samples, double p ) {
+      if( samples.empty() ) return T{};
+      std::sort( samples.begin(), samples.end() );
+      size_t rank = static_cast<size_t>( p / 100.0 * ( samples.size() - 1 ) + 0.5 );
+      return samples[ std::min( rank, samples.size() - 1 ) ];
+   }
+
+} /// namespace bench
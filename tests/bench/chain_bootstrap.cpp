@@ -0,0 +1,265 @@
+#include <boost/test/unit_test.hpp>
+#include <eosio/chain/snapshot.hpp>
+
+#define TESTER tester
+#include "../eosio.system_tester.hpp"
+#include "bench_options.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+
+using namespace eosio_system;
+
+namespace {
+
+/**
+ * Builds a synthetic eosio.system population from a seed: producers, proxies, voters
+ * split between proxies and direct votes, name bids and RAM holders. The same seed and
+ * counts always produce the same sequence of actions, so the resulting snapshot can be
+ * shared as a common baseline for profiling.
+ */
+class chain_generator : public eosio_system_tester {
+public:
+
+   chain_generator( uint64_t seed ) : eosio_system_tester( setup_level::deploy_contract ), rng( seed ) {}
+
+   /// `prefix` padded to `length` characters with base-31 digits; 12-character names need no name bid
+   static account_name synthetic_name( const std::string& prefix, uint32_t i, size_t length = 12 ) {
+      static const char digits[] = "abcdefghijklmnopqrstuvwxyz12345";
+      std::string s = prefix;
+      while( s.size() < length ) {
+         s += digits[i % 31];
+         i /= 31;
+      }
+      return account_name( s );
+   }
+
+   static vector<account_name> synthetic_names( const std::string& prefix, uint32_t count ) {
+      vector<account_name> names;
+      names.reserve( count );
+      for( uint32_t i = 0; i < count; ++i ) {
+         names.push_back( synthetic_name( prefix, i ) );
+      }
+      return names;
+   }
+
+   /// whole tokens, log-uniform in [lo, hi]
+   asset random_amount( double lo, double hi ) {
+      std::uniform_real_distribution<double> dist( std::log( lo ), std::log( hi ) );
+      return asset( static_cast<int64_t>( std::exp( dist( rng ) ) ) * 10000, symbol{CORE_SYM} );
+   }
+
+   /// queues `act` signed by `signers`, pushing a transaction every `batch_size` actions
+   void queue( action act, std::initializer_list<account_name> signers ) {
+      pending.push_back( std::move( act ) );
+      pending_signers.insert( signers.begin(), signers.end() );
+      if( pending.size() >= batch_size ) {
+         flush();
+      }
+   }
+
+   void flush() {
+      if( pending.empty() ) return;
+
+      signed_transaction trx;
+      trx.actions = std::move( pending );
+      set_transaction_headers( trx );
+      for( const auto& s : pending_signers ) {
+         trx.sign( get_private_key( s, "active" ), control->get_chain_id() );
+      }
+      push_transaction( trx );
+
+      pending.clear();
+      pending_signers.clear();
+      if( ++pushed % trx_per_block == 0 ) {
+         produce_block();
+      }
+   }
+
+   /// new accounts staking `stake` of their own tokens and holding `liquid` more
+   void create_population( const vector<account_name>& names, std::function<asset()> stake, asset liquid ) {
+      const account_name creator = config::system_account_name;
+      for( const auto& a : names ) {
+         queue( action( vector<permission_level>{{creator, config::active_name}},
+                        newaccount{
+                           .creator  = creator,
+                           .name     = a,
+                           .owner    = authority( get_public_key( a, "owner" ) ),
+                           .active   = authority( get_public_key( a, "active" ) )
+                        } ), { creator } );
+         queue( get_action( config::system_account_name, N(buyrambytes), vector<permission_level>{{creator, config::active_name}},
+                            mvo()
+                            ("payer", creator)
+                            ("receiver", a)
+                            ("bytes", 8000) ), { creator } );
+
+         const auto s = stake();
+         const auto net = asset( s.get_amount() / 2, s.get_symbol() );
+         queue( get_action( config::system_account_name, N(delegatebw), vector<permission_level>{{creator, config::active_name}},
+                            mvo()
+                            ("from", creator)
+                            ("receiver", a)
+                            ("stake_net_quantity", net )
+                            ("stake_cpu_quantity", s - net )
+                            ("transfer", 1 ) ), { creator } );
+         if( liquid.get_amount() > 0 ) {
+            queue( get_action( N(eosio.token), N(transfer), vector<permission_level>{{creator, config::active_name}},
+                               mvo()
+                               ("from", creator)
+                               ("to", a)
+                               ("quantity", liquid)
+                               ("memo", "") ), { creator } );
+         }
+      }
+      flush();
+   }
+
+   void generate( const bench::options::population& pop ) {
+      producers   = synthetic_names( "prod", pop.producers );
+      proxies     = synthetic_names( "proxy", pop.proxies );
+      voters      = synthetic_names( "voter", pop.voters );
+      bidders     = synthetic_names( "bidder", pop.bidders );
+      ram_holders = synthetic_names( "ramer", pop.ram_holders );
+
+      const asset none = core_sym::from_string("0.0000");
+      create_population( producers,   [&]{ return random_amount( 100, 10000 ); },  none );
+      create_population( proxies,     [&]{ return random_amount( 100, 100000 ); }, none );
+      create_population( voters,      [&]{ return random_amount( 100, 20000 ); },  none );
+      create_population( bidders,     [&]{ return random_amount( 100, 1000 ); },   core_sym::from_string("10000.0000") );
+      create_population( ram_holders, [&]{ return random_amount( 100, 1000 ); },   core_sym::from_string("1000.0000") );
+
+      for( const auto& p : producers ) {
+         queue( get_action( config::system_account_name, N(regproducer), vector<permission_level>{{p, config::active_name}},
+                            mvo()
+                            ("producer",     p)
+                            ("producer_key", get_public_key( p, "active" ))
+                            ("url",          "")
+                            ("location",     0) ), { p } );
+      }
+      for( const auto& p : proxies ) {
+         queue( get_action( config::system_account_name, N(regproxy), vector<permission_level>{{p, config::active_name}},
+                            mvo()
+                            ("proxy",   p)
+                            ("isproxy", true) ), { p } );
+      }
+      flush();
+
+      // proxies vote first so proxied weight flows into producers as voters arrive
+      for( const auto& p : proxies ) {
+         queue( vote_action( p ), { p } );
+      }
+      for( const auto& v : voters ) {
+         queue( vote_action( v ), { v } );
+      }
+      flush();
+
+      place_bids( pop.bidders );
+
+      for( const auto& r : ram_holders ) {
+         queue( get_action( config::system_account_name, N(buyram), vector<permission_level>{{r, config::active_name}},
+                            mvo()
+                            ("payer",    r)
+                            ("receiver", r)
+                            ("quant",    random_amount( 1, 1000 )) ), { r } );
+      }
+      flush();
+      produce_block();
+   }
+
+   /// 30% of plain voters use a proxy, the rest vote for 1-30 random producers
+   action vote_action( account_name voter ) {
+      account_name proxy;
+      vector<account_name> votes;
+      const bool is_proxy = std::find( proxies.begin(), proxies.end(), voter ) != proxies.end();
+      if( !is_proxy && !proxies.empty() && std::uniform_int_distribution<int>( 0, 9 )( rng ) < 3 ) {
+         proxy = proxies[ std::uniform_int_distribution<size_t>( 0, proxies.size() - 1 )( rng ) ];
+      } else if( !producers.empty() ) {
+         const size_t k = std::uniform_int_distribution<size_t>( 1, std::min<size_t>( 30, producers.size() ) )( rng );
+         std::set<account_name> chosen;
+         while( chosen.size() < k ) {
+            chosen.insert( producers[ std::uniform_int_distribution<size_t>( 0, producers.size() - 1 )( rng ) ] );
+         }
+         votes.assign( chosen.begin(), chosen.end() );
+      }
+      return get_action( config::system_account_name, N(voteproducer), vector<permission_level>{{voter, config::active_name}},
+                         mvo()
+                         ("voter",     voter)
+                         ("proxy",     proxy)
+                         ("producers", votes) );
+   }
+
+   /// each bidder bids once on one of bidders/2 premium names, outbidding the current high bid by more than 10%
+   void place_bids( uint32_t count ) {
+      const uint32_t name_count = std::max<uint32_t>( count / 2, 1 );
+      std::map<account_name, std::pair<account_name, int64_t>> high;   // name -> (bidder, bid)
+      for( const auto& b : bidders ) {
+         const auto newname = synthetic_name( "bid", std::uniform_int_distribution<uint32_t>( 0, name_count - 1 )( rng ), 8 );
+         auto& h = high[newname];
+         if( h.first == b ) continue;
+         const int64_t amount = std::max( random_amount( 1, 100 ).get_amount(), h.second + h.second / 10 + 1 );
+         if( amount > core_sym::from_string("10000.0000").get_amount() ) continue;
+         h = { b, amount };
+         queue( get_action( config::system_account_name, N(bidname), vector<permission_level>{{b, config::active_name}},
+                            mvo()
+                            ("bidder",  b)
+                            ("newname", newname)
+                            ("bid",     asset( amount, symbol{CORE_SYM} )) ), { b } );
+      }
+      flush();
+   }
+
+   void write_snapshot( const std::string& path ) {
+      control->abort_block();
+      std::ofstream out( path, std::ios::out | std::ios::binary );
+      auto writer = std::make_shared<ostream_snapshot_writer>( out );
+      control->write_snapshot( writer );
+      writer->finalize();
+      out.flush();
+   }
+
+   std::mt19937_64                rng;
+   const size_t                   batch_size = 60;
+   /// --trx-per-block, capped at half a block: every transaction is billed the tester's fixed cpu time
+   const uint64_t                 trx_per_block = std::min<uint64_t>( bench::get_options().trx_per_block,
+                                                    control->get_global_properties().configuration.max_block_cpu_usage
+                                                    / DEFAULT_BILLED_CPU_TIME_US / 2 );
+   vector<action>                 pending;
+   std::set<account_name>         pending_signers;
+   uint64_t                       pushed = 0;
+
+   vector<account_name>           producers;
+   vector<account_name>           proxies;
+   vector<account_name>           voters;
+   vector<account_name>           bidders;
+   vector<account_name>           ram_holders;
+};
+
+} /// anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(chain_bootstrap)
+
+BOOST_AUTO_TEST_CASE( generate_snapshot ) try {
+   const auto& pop = bench::get_options().chain;
+
+   std::cout << "chain bootstrap: seed " << pop.seed << ", " << pop.producers << " producers, " << pop.proxies << " proxies, "
+             << pop.voters << " voters, " << pop.bidders << " bidders, " << pop.ram_holders << " ram holders" << std::endl;
+
+   auto start = fc::time_point::now();
+   chain_generator g( pop.seed );
+   g.generate( pop );
+   std::cout << "generated " << g.pushed << " transactions up to block " << g.control->head_block_num()
+             << " in " << ( fc::time_point::now() - start ).count() / 1000 << " ms" << std::endl;
+
+   if( !pop.snapshot.empty() ) {
+      g.write_snapshot( pop.snapshot );
+      std::cout << "snapshot written to " << pop.snapshot << std::endl;
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
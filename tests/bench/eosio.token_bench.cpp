@@ -0,0 +1,184 @@
+#include <boost/test/unit_test.hpp>
+#include <eosio/chain/resource_limits.hpp>
+
+#include "../eosio.token_tester.hpp"
+#include "bench_options.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+using namespace eosio::chain::resource_limits;
+
+namespace {
+
+// contract that accepts every notification and does nothing with it
+const char* noop_receiver_wast = R"=====(
+(module
+ (export "apply" (func $apply))
+ (func $apply (param $0 i64) (param $1 i64) (param $2 i64))
+)
+)=====";
+
+struct transfer_run {
+   uint32_t          accounts  = 0;
+   bool              receivers = false;
+   uint32_t          transfers = 0;
+   double            tps       = 0;
+   vector<int64_t>   billed_cpu_us;
+   vector<int64_t>   elapsed_us;
+   int64_t           ram_delta = 0;
+
+   static void print_header( std::ostream& os ) {
+      os << std::setw(9)  << "accounts"
+         << std::setw(10) << "receivers"
+         << std::setw(10) << "transfers"
+         << std::setw(10) << "tps"
+         << std::setw(9)  << "cpu p50"
+         << std::setw(9)  << "cpu p90"
+         << std::setw(9)  << "cpu p99"
+         << std::setw(9)  << "cpu max"
+         << std::setw(10) << "exec p50"
+         << std::setw(10) << "exec p99"
+         << std::setw(11) << "ram delta" << std::endl;
+   }
+
+   void print( std::ostream& os ) {
+      os << std::setw(9)  << accounts
+         << std::setw(10) << ( receivers ? "yes" : "no" )
+         << std::setw(10) << transfers
+         << std::setw(10) << std::fixed << std::setprecision(0) << tps
+         << std::setw(9)  << bench::percentile( billed_cpu_us, 50 )
+         << std::setw(9)  << bench::percentile( billed_cpu_us, 90 )
+         << std::setw(9)  << bench::percentile( billed_cpu_us, 99 )
+         << std::setw(9)  << bench::percentile( billed_cpu_us, 100 )
+         << std::setw(10) << bench::percentile( elapsed_us, 50 )
+         << std::setw(10) << bench::percentile( elapsed_us, 99 )
+         << std::setw(11) << ram_delta << std::endl;
+   }
+};
+
+class token_bench_tester : public eosio_token_tester {
+public:
+
+   /// "bench" followed by 7 base-31 digits, enough for any realistic sweep
+   static account_name bench_account( uint32_t i ) {
+      static const char digits[] = "abcdefghijklmnopqrstuvwxyz12345";
+      std::string s = "bench";
+      for( int k = 0; k < 7; ++k ) {
+         s += digits[i % 31];
+         i /= 31;
+      }
+      return account_name( s );
+   }
+
+   void setup( uint32_t accounts, bool receivers ) {
+      BOOST_REQUIRE( accounts >= 2 );
+
+      vector<account_name> names;
+      for( uint32_t i = 0; i < accounts; ++i ) {
+         names.push_back( bench_account( i ) );
+         if( names.size() == 50 || i + 1 == accounts ) {
+            create_accounts( names );
+            produce_block();
+            names.clear();
+         }
+      }
+
+      BOOST_REQUIRE_EQUAL( success(), create( N(alice), asset::from_string("10000000000.0000 BNC") ) );
+      for( uint32_t i = 0; i < accounts; ++i ) {
+         BOOST_REQUIRE_EQUAL( success(), issue( N(alice), bench_account( i ), asset::from_string("1000.0000 BNC"), "" ) );
+         if( receivers ) {
+            set_code( bench_account( i ), noop_receiver_wast );
+         }
+         if( ( i + 1 ) % bench::get_options().trx_per_block == 0 ) {
+            produce_block();
+         }
+      }
+      produce_block();
+   }
+
+   int64_t total_ram( uint32_t accounts ) const {
+      const auto& rlm = control->get_resource_limits_manager();
+      int64_t total = rlm.get_account_ram_usage( N(eosio.token) ) + rlm.get_account_ram_usage( N(alice) );
+      for( uint32_t i = 0; i < accounts; ++i ) {
+         total += rlm.get_account_ram_usage( bench_account( i ) );
+      }
+      return total;
+   }
+
+   /**
+    * Pushes `transfers` single-action transactions round-robin over `accounts` senders,
+    * each sender cycling through every other account as recipient. Throughput only counts
+    * time spent inside push_transaction, not signing or block production.
+    */
+   transfer_run run( uint32_t transfers, uint32_t accounts, bool receivers ) {
+      transfer_run r;
+      r.accounts  = accounts;
+      r.receivers = receivers;
+      r.transfers = transfers;
+      r.billed_cpu_us.reserve( transfers );
+      r.elapsed_us.reserve( transfers );
+
+      const auto quantity = asset::from_string("0.0001 BNC");
+      const auto ram_before = total_ram( accounts );
+      fc::microseconds push_time;
+
+      for( uint32_t i = 0; i < transfers; ++i ) {
+         const uint32_t from_idx = i % accounts;
+         const uint32_t to_idx   = ( from_idx + 1 + ( i / accounts ) % ( accounts - 1 ) ) % accounts;
+         const auto from = bench_account( from_idx );
+         const auto to   = bench_account( to_idx );
+
+         signed_transaction trx;
+         trx.actions.emplace_back( vector<permission_level>{ { from, config::active_name } },
+                                   N(eosio.token), N(transfer),
+                                   abi_ser.variant_to_binary( "transfer", mvo()
+                                      ( "from", from )
+                                      ( "to", to )
+                                      ( "quantity", quantity )
+                                      ( "memo", std::to_string( i ) ),
+                                      abi_serializer_max_time ) );
+         set_transaction_headers( trx );
+         trx.sign( get_private_key( from, "active" ), control->get_chain_id() );
+
+         // billed_cpu_time_us = 0 bills measured cpu instead of the tester's fixed default
+         auto start = fc::time_point::now();
+         auto trace = push_transaction( trx, fc::time_point::maximum(), 0 );
+         push_time += fc::time_point::now() - start;
+
+         r.billed_cpu_us.push_back( trace->receipt->cpu_usage_us );
+         r.elapsed_us.push_back( trace->elapsed.count() );
+
+         if( ( i + 1 ) % bench::get_options().trx_per_block == 0 ) {
+            produce_block();
+         }
+      }
+      produce_block();
+
+      r.tps = push_time.count() > 0 ? double( transfers ) * 1000000 / push_time.count() : 0;
+      r.ram_delta = total_ram( accounts ) - ram_before;
+      return r;
+   }
+};
+
+} /// anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(eosio_token_bench)
+
+BOOST_AUTO_TEST_CASE( transfer_throughput ) try {
+   const auto& opts = bench::get_options();
+
+   std::cout << "eosio.token transfer: " << opts.transfers << " transfers per run, "
+             << opts.trx_per_block << " per block; cpu in billed us, exec in measured us" << std::endl;
+   transfer_run::print_header( std::cout );
+
+   for( auto accounts : opts.account_counts ) {
+      for( bool receivers : { false, true } ) {
+         token_bench_tester t;
+         t.setup( accounts, receivers );
+         t.run( opts.transfers, accounts, receivers ).print( std::cout );
+      }
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
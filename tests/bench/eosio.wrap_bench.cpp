@@ -0,0 +1,106 @@
+#include <boost/test/unit_test.hpp>
+
+#include "../eosio.wrap_tester.hpp"
+#include "bench_options.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+struct wrap_run {
+   std::string       mode;
+   uint32_t          execs = 0;
+   vector<int64_t>   billed_cpu_us;
+   vector<int64_t>   elapsed_us;
+   vector<int64_t>   latency_blocks;
+
+   static void print_header( std::ostream& os ) {
+      os << std::setw(12) << "mode"
+         << std::setw(7)  << "execs"
+         << std::setw(9)  << "cpu p50"
+         << std::setw(9)  << "cpu p99"
+         << std::setw(10) << "exec p50"
+         << std::setw(10) << "exec p99"
+         << std::setw(10) << "blocks" << std::endl;
+   }
+
+   void print( std::ostream& os ) {
+      os << std::setw(12) << mode
+         << std::setw(7)  << execs
+         << std::setw(9)  << bench::percentile( billed_cpu_us, 50 )
+         << std::setw(9)  << bench::percentile( billed_cpu_us, 99 )
+         << std::setw(10) << bench::percentile( elapsed_us, 50 )
+         << std::setw(10) << bench::percentile( elapsed_us, 99 )
+         << std::setw(10) << bench::percentile( latency_blocks, 100 ) << std::endl;
+   }
+};
+
+class wrap_bench_tester : public eosio_wrap_tester {
+public:
+
+   /**
+    * Executes `execs` wrapped reqauth transactions through `exec_action`. Costs add up the
+    * wrapping transaction and, for `exec`, the deferred transaction it schedules; latency is
+    * the number of blocks between pushing the wrapping transaction and the reqauth running.
+    */
+   wrap_run run( uint32_t execs, action_name exec_action ) {
+      wrap_run r;
+      r.mode  = name{exec_action}.to_string();
+      r.execs = execs;
+
+      transaction_trace_ptr scheduled;
+      auto conn = control->applied_transaction.connect( [&]( const transaction_trace_ptr& t ) {
+         if( t->scheduled ) scheduled = t;
+      } );
+
+      const auto trx = reqauth( N(bob), {permission_level{N(bob), config::active_name}} );
+      for( uint32_t i = 0; i < execs; ++i ) {
+         signed_transaction wrap_trx( wrap_exec( N(alice), trx, base_tester::DEFAULT_EXPIRATION_DELTA, exec_action ), {}, {} );
+         wrap_trx.sign( get_private_key( N(alice), "active" ), control->get_chain_id() );
+         for( const auto& actor : {"prod1", "prod2", "prod3", "prod4"} ) {
+            wrap_trx.sign( get_private_key( actor, "active" ), control->get_chain_id() );
+         }
+
+         scheduled.reset();
+         // billed_cpu_time_us = 0 bills measured cpu instead of the tester's fixed default
+         auto trace = push_transaction( wrap_trx, fc::time_point::maximum(), 0 );
+         produce_block();
+
+         int64_t cpu     = trace->receipt->cpu_usage_us;
+         int64_t elapsed = trace->elapsed.count();
+         int64_t blocks  = 0;
+         if( scheduled ) {
+            BOOST_REQUIRE_EQUAL( transaction_receipt::executed, scheduled->receipt->status );
+            cpu     += scheduled->receipt->cpu_usage_us;
+            elapsed += scheduled->elapsed.count();
+            blocks   = scheduled->block_num - trace->block_num;
+         }
+         r.billed_cpu_us.push_back( cpu );
+         r.elapsed_us.push_back( elapsed );
+         r.latency_blocks.push_back( blocks );
+      }
+
+      conn.disconnect();
+      return r;
+   }
+};
+
+} /// anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(eosio_wrap_bench)
+
+BOOST_AUTO_TEST_CASE( exec_deferred_vs_inline ) try {
+   const auto& opts = bench::get_options();
+
+   std::cout << "eosio.wrap: " << opts.wrap_execs << " wrapped reqauth per mode; cpu in billed us, exec in measured us, "
+             << "blocks until the wrapped action runs" << std::endl;
+   wrap_run::print_header( std::cout );
+
+   for( auto exec_action : { N(exec), N(execinline) } ) {
+      wrap_bench_tester t;
+      t.run( opts.wrap_execs, exec_action ).print( std::cout );
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
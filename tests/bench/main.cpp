@@ -0,0 +1,71 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <boost/test/included/unit_test.hpp>
+#include <fc/log/logger.hpp>
+#include <eosio/chain/exceptions.hpp>
+
+#include "bench_options.hpp"
+
+#define BOOST_TEST_STATIC_LINK
+
+namespace {
+
+   std::vector<uint32_t> parse_counts( const std::string& csv ) {
+      std::vector<std::string> parts;
+      boost::split( parts, csv, boost::is_any_of(",") );
+      std::vector<uint32_t> counts;
+      for( const auto& p : parts ) {
+         if( !p.empty() ) counts.push_back( std::stoul( p ) );
+      }
+      return counts;
+   }
+
+}
+
+void translate_fc_exception(const fc::exception &e) {
+   std::cerr << "\033[33m" <<  e.to_detail_string() << "\033[0m" << std::endl;
+   BOOST_TEST_FAIL("Caught Unexpected Exception");
+}
+
+boost::unit_test::test_suite* init_unit_test_suite(int argc, char* argv[]) {
+   auto& opts = bench::get_options();
+   bool is_verbose = false;
+   for (int i = 0; i < argc; i++) {
+      std::string arg = argv[i];
+      if (arg == "--verbose") {
+         is_verbose = true;
+      } else if (boost::starts_with(arg, "--transfers=")) {
+         opts.transfers = std::stoul( arg.substr(12) );
+      } else if (boost::starts_with(arg, "--accounts=")) {
+         opts.account_counts = parse_counts( arg.substr(11) );
+      } else if (boost::starts_with(arg, "--trx-per-block=")) {
+         opts.trx_per_block = std::stoul( arg.substr(16) );
+      } else if (boost::starts_with(arg, "--wrap-execs=")) {
+         opts.wrap_execs = std::stoul( arg.substr(13) );
+      } else if (boost::starts_with(arg, "--decoder-iterations=")) {
+         opts.decoder_iterations = std::stoul( arg.substr(21) );
+      } else if (boost::starts_with(arg, "--seed=")) {
+         opts.chain.seed = std::stoull( arg.substr(7) );
+      } else if (boost::starts_with(arg, "--producers=")) {
+         opts.chain.producers = std::stoul( arg.substr(12) );
+      } else if (boost::starts_with(arg, "--proxies=")) {
+         opts.chain.proxies = std::stoul( arg.substr(10) );
+      } else if (boost::starts_with(arg, "--voters=")) {
+         opts.chain.voters = std::stoul( arg.substr(9) );
+      } else if (boost::starts_with(arg, "--bidders=")) {
+         opts.chain.bidders = std::stoul( arg.substr(10) );
+      } else if (boost::starts_with(arg, "--ram-holders=")) {
+         opts.chain.ram_holders = std::stoul( arg.substr(14) );
+      } else if (boost::starts_with(arg, "--snapshot=")) {
+         opts.chain.snapshot = arg.substr(11);
+      }
+   }
+   if(!is_verbose) fc::logger::get(DEFAULT_LOGGER).set_log_level(fc::log_level::off);
+
+   // Register fc::exception translator
+   boost::unit_test::unit_test_monitor.template register_exception_translator<fc::exception>(&translate_fc_exception);
+
+   return nullptr;
+}
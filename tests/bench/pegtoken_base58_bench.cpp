@@ -0,0 +1,171 @@
+#include <boost/test/unit_test.hpp>
+
+#include "../../bos.pegtoken/include/bos.pegtoken/base58.hpp"
+#include "bench_options.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// decoder replaced by eosio::unbase58, kept as the reference for the differential fuzz
+bool legacy_unbase58( const char* s, unsigned char* out ) {
+   static const char* tmpl = "123456789"
+                             "ABCDEFGHJKLMNPQRSTUVWXYZ"
+                             "abcdefghijkmnopqrstuvwxyz";
+   int i, j, c;
+   const char* p;
+
+   memset( out, 0, 25 );
+   for( i = 0; s[i]; i++ ) {
+      if( !( p = std::strchr( tmpl, s[i] ) ) )
+         return false;
+
+      c = p - tmpl;
+      for( j = 25; j--; ) {
+         c += 58 * out[j];
+         out[j] = c % 256;
+         c /= 256;
+      }
+
+      if( c )
+         return false;
+   }
+
+   return true;
+}
+
+const std::vector<std::string> base58_corpus = {
+   "1A1zP1eP5QGefi2DMPTfTL5SLmv7DivfNa",
+   "1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2",
+   "3J98t1WpEZ73CNmQviecrnyiWrnqRhWNLy",
+   "mipcBbFg9gMiCh81Kj8tqqdgoZub1ZJRfn",
+   "2MzQwSSnBHWHqSAqtTVQ6v47XtaisrJa1Vc",
+   "1111111111111111111114oLvT2",
+   "zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz",
+   "",
+};
+
+// BIP173 / BIP350 test vectors for hrp "bc"
+const std::vector<std::string> segwit_valid = {
+   "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t4",
+   "BC1QW508D6QEJXTDG4Y5R3ZARVARY0C5XW7KV8F3T4",
+   "bc1qrp33g0q5c5txsp9arysrx4k6zdkfs4nce4xj0gdcccefvpysxf3qccfmv3",
+   "bc1pw508d6qejxtdg4y5r3zarvary0c5xw7kw508d6qejxtdg4y5r3zarvary0c5xw7kt5nd6y",
+   "bc1sw50qgdz25j",
+   "bc1zw508d6qejxtdg4y5r3zarvaryvaxxpcs",
+   "bc1p0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vqzk5jj0",
+};
+
+const std::vector<std::string> segwit_invalid = {
+   "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t5",                        // bad checksum
+   "bc1p0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vqh2y7hd",    // version 1 with bech32 checksum
+   "BC1S0XLXVLHEMJA6C4DQV22UAPCTQUPFHLXM9H8Z3K2E72Q4K9HCZ7VQ54WELL",    // version 16 with bech32 checksum
+   "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kemeawh",                        // version 0 with bech32m checksum
+   "BC130XLXVLHEMJA6C4DQV22UAPCTQUPFHLXM9H8Z3K2E72Q4K9HCZ7VQ7ZWS8R",    // invalid witness version
+   "bc1pw5dgrnzv",                                                       // program too short
+   "bc1q0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7v8n0nx0muaewav253zgeav", // program too long
+   "BC1QR508D6QEJXTDG4Y5R3ZARVARYV98GJ9P",                               // invalid program length for version 0
+   "bc1p38j9r5y49hruaue7wxjce0updqjuyyx0kh56v8s25huc6995vvpql3jow4",    // character outside the charset
+   "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kV8f3t4",                        // mixed case
+   "bc1zw508d6qejxtdg4y5r3zarvaryvqyzf3du",                             // zero padding of more than 4 bits
+   "bc1gmk9yu",                                                          // empty data
+};
+
+/// `count` strings around the corpus: point mutations, truncations, extensions and random base58 text
+std::vector<std::string> fuzz_inputs( std::mt19937_64& rng, uint32_t count ) {
+   static const char chars[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz0OIl+/ ";
+   std::uniform_int_distribution<size_t> pick_char( 0, sizeof( chars ) - 2 );
+   std::uniform_int_distribution<size_t> pick_seed( 0, base58_corpus.size() - 1 );
+
+   std::vector<std::string> inputs;
+   inputs.reserve( count );
+   while( inputs.size() < count ) {
+      std::string s = base58_corpus[ pick_seed( rng ) ];
+      switch( rng() % 4 ) {
+         case 0:
+            if( !s.empty() ) s[ rng() % s.size() ] = chars[ pick_char( rng ) ];
+            break;
+         case 1:
+            s.resize( s.empty() ? 0 : rng() % s.size() );
+            break;
+         case 2:
+            for( auto n = rng() % 4 + 1; n--; ) s += chars[ pick_char( rng ) ];
+            break;
+         default:
+            s.resize( rng() % 40 );
+            for( auto& c : s ) c = chars[ pick_char( rng ) % 58 ];
+            break;
+      }
+      inputs.push_back( std::move( s ) );
+   }
+   return inputs;
+}
+
+template<typename Decoder>
+double decode_ns( Decoder decode, const std::vector<std::string>& inputs, uint32_t iterations ) {
+   unsigned char out[25];
+   uint64_t sink = 0;
+   auto start = std::chrono::steady_clock::now();
+   for( uint32_t i = 0; i < iterations; ++i ) {
+      sink += decode( inputs[ i % inputs.size() ].c_str(), out ) ? out[24] : 1;
+   }
+   auto elapsed = std::chrono::steady_clock::now() - start;
+   // keep the loop from being optimized away
+   BOOST_REQUIRE( sink != uint64_t(-1) );
+   return std::chrono::duration<double, std::nano>( elapsed ).count() / iterations;
+}
+
+} /// anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(pegtoken_base58_bench)
+
+BOOST_AUTO_TEST_CASE( segwit_vectors ) {
+   for( const auto& a : segwit_valid ) {
+      BOOST_TEST_CONTEXT( a ) BOOST_CHECK( eosio::valid_segwit_addr( a.data(), a.size(), "bc" ) );
+   }
+   for( const auto& a : segwit_invalid ) {
+      BOOST_TEST_CONTEXT( a ) BOOST_CHECK( !eosio::valid_segwit_addr( a.data(), a.size(), "bc" ) );
+   }
+   const std::string testnet = "tb1qrp33g0q5c5txsp9arysrx4k6zdkfs4nce4xj0gdcccefvpysxf3q0sl5k7";
+   BOOST_CHECK( eosio::valid_segwit_addr( testnet.data(), testnet.size(), "tb" ) );
+   BOOST_CHECK( !eosio::valid_segwit_addr( testnet.data(), testnet.size(), "bc" ) );
+}
+
+BOOST_AUTO_TEST_CASE( unbase58_differential ) {
+   std::mt19937_64 rng( bench::get_options().chain.seed );
+   auto inputs = fuzz_inputs( rng, 100000 );
+   inputs.insert( inputs.end(), base58_corpus.begin(), base58_corpus.end() );
+
+   uint32_t accepted = 0;
+   for( const auto& s : inputs ) {
+      unsigned char expected[25], actual[25];
+      const bool ok = legacy_unbase58( s.c_str(), expected );
+      BOOST_TEST_CONTEXT( s ) {
+         BOOST_REQUIRE_EQUAL( ok, eosio::unbase58( s.c_str(), actual ) );
+         if( ok ) {
+            ++accepted;
+            BOOST_REQUIRE( std::memcmp( expected, actual, 25 ) == 0 );
+         }
+      }
+   }
+   BOOST_TEST_MESSAGE( accepted << " of " << inputs.size() << " fuzz inputs decoded" );
+}
+
+BOOST_AUTO_TEST_CASE( unbase58_timing ) {
+   const auto iterations = bench::get_options().decoder_iterations;
+   const std::vector<std::string> inputs( base58_corpus.begin(), base58_corpus.begin() + 5 );
+
+   const auto legacy  = decode_ns( legacy_unbase58, inputs, iterations );
+   const auto current = decode_ns( eosio::unbase58, inputs, iterations );
+   std::cout << "unbase58: " << iterations << " decodes of 34 and 35 character addresses" << std::endl
+             << std::setw(10) << "legacy"  << std::setw(10) << std::fixed << std::setprecision(1) << legacy  << " ns" << std::endl
+             << std::setw(10) << "limbs"   << std::setw(10) << std::fixed << std::setprecision(1) << current << " ns" << std::endl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
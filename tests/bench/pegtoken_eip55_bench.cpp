@@ -0,0 +1,156 @@
+#include <boost/test/unit_test.hpp>
+
+#include "../../bos.pegtoken/include/bos.pegtoken/eip55.hpp"
+#include "bench_options.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// loop form of the generic sponge the contract used through sha3.h, kept as the reference
+void legacy_keccak_256( uint8_t out[32], const uint8_t* in, size_t inlen ) {
+   static const uint8_t rho[24] = { 1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14,
+                                    27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44 };
+   static const uint8_t pi[24]  = { 10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4,
+                                    15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1 };
+   const size_t rate = 136;
+
+   uint8_t state[200] = {};
+   for( size_t i = 0; i < inlen; ++i ) state[i] ^= in[i];
+   state[inlen] ^= 0x01;
+   state[rate - 1] ^= 0x80;
+
+   uint64_t a[25];
+   std::memcpy( a, state, sizeof( a ) );
+   for( int round = 0; round < 24; ++round ) {
+      uint64_t b[5];
+      for( int x = 0; x < 5; ++x ) b[x] = a[x] ^ a[x + 5] ^ a[x + 10] ^ a[x + 15] ^ a[x + 20];
+      for( int x = 0; x < 5; ++x )
+         for( int y = 0; y < 25; y += 5 )
+            a[y + x] ^= b[(x + 4) % 5] ^ eosio::decoder_detail::rotl( b[(x + 1) % 5], 1 );
+      uint64_t t = a[1];
+      for( int i = 0; i < 24; ++i ) {
+         b[0] = a[pi[i]];
+         a[pi[i]] = eosio::decoder_detail::rotl( t, rho[i] );
+         t = b[0];
+      }
+      for( int y = 0; y < 25; y += 5 ) {
+         for( int x = 0; x < 5; ++x ) b[x] = a[y + x];
+         for( int x = 0; x < 5; ++x ) a[y + x] = b[x] ^ ( ~b[(x + 1) % 5] & b[(x + 2) % 5] );
+      }
+      a[0] ^= eosio::decoder_detail::keccak_round_constants[round];
+   }
+   std::memcpy( out, a, 32 );
+}
+
+// validator replaced by eosio::valid_eip55_checksum: lowercase copy, full digest
+// hex-encoded, rebuilt mixed-case copy compared with the input
+bool legacy_eip55( std::string addr ) {
+   static const char hex_map[] = "0123456789abcdef";
+   auto origin_addr = addr;
+   std::transform( addr.begin(), addr.end(), addr.begin(), ::tolower );
+
+   uint8_t out[32];
+   legacy_keccak_256( out, reinterpret_cast<const uint8_t*>( addr.data() ), addr.size() );
+   std::string mask( 64, 0 );
+   for( int i = 0; i < 32; ++i ) {
+      mask[2 * i]     = hex_map[ out[i] >> 4 ];
+      mask[2 * i + 1] = hex_map[ out[i] & 0x0f ];
+   }
+   for( size_t i = 0; i < addr.size(); ++i ) {
+      const int nibble = mask[i] <= '9' ? mask[i] - '0' : mask[i] - 'a' + 10;
+      addr[i] = nibble > 7 ? ::toupper( addr[i] ) : ::tolower( addr[i] );
+   }
+   return addr == origin_addr;
+}
+
+// EIP-55 test vectors, without 0x
+const std::vector<std::string> checksummed = {
+   "52908400098527886E0F7030069857D2E4169EE7",
+   "8617E340B3D01FA5F11F306F4090FD50E238070D",
+   "de709f2102306220921060314715629080e2fb77",
+   "27b1fdb04752bbc536007a920d24acb045561c26",
+   "5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAed",
+   "fB6916095ca1df60bB79Ce92cE3Ea74c37c5d359",
+   "dbF03B407c01E7cD3CBea99509d93f8DDDC8C6FB",
+   "D1220A0cf47c7B9Be7A2E6BA89F429762e7b9aDb",
+};
+
+/// `count` 40-digit hex strings: checksummed vectors with one letter's case flipped, and random hex in random case
+std::vector<std::string> fuzz_inputs( std::mt19937_64& rng, uint32_t count ) {
+   static const char digits[] = "0123456789abcdefABCDEF";
+   std::vector<std::string> inputs;
+   inputs.reserve( count );
+   while( inputs.size() < count ) {
+      std::string s;
+      if( rng() % 2 ) {
+         s = checksummed[ rng() % checksummed.size() ];
+         auto& c = s[ rng() % s.size() ];
+         if( ::isalpha( c ) ) c ^= 0x20;
+      } else {
+         s.resize( 40 );
+         for( auto& c : s ) c = digits[ rng() % ( sizeof( digits ) - 1 ) ];
+      }
+      inputs.push_back( std::move( s ) );
+   }
+   return inputs;
+}
+
+template<typename Validator>
+double validate_ns( Validator validate, const std::vector<std::string>& inputs, uint32_t iterations ) {
+   uint64_t accepted = 0;
+   auto start = std::chrono::steady_clock::now();
+   for( uint32_t i = 0; i < iterations; ++i ) {
+      accepted += validate( inputs[ i % inputs.size() ] );
+   }
+   auto elapsed = std::chrono::steady_clock::now() - start;
+   // keep the loop from being optimized away
+   BOOST_REQUIRE( accepted <= iterations );
+   return std::chrono::duration<double, std::nano>( elapsed ).count() / iterations;
+}
+
+} /// anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(pegtoken_eip55_bench)
+
+BOOST_AUTO_TEST_CASE( eip55_vectors ) {
+   for( const auto& a : checksummed ) {
+      BOOST_TEST_CONTEXT( a ) BOOST_CHECK( eosio::valid_eip55_checksum( a.c_str() ) );
+   }
+   BOOST_CHECK( !eosio::valid_eip55_checksum( "5aaeb6053f3e94c9b9a09f33669435e7ef1beaed" ) );
+   BOOST_CHECK( !eosio::valid_eip55_checksum( "5AAEB6053F3E94C9B9A09F33669435E7EF1BEAED" ) );
+   BOOST_CHECK( !eosio::valid_eip55_checksum( "5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAeg" ) );
+}
+
+BOOST_AUTO_TEST_CASE( eip55_differential ) {
+   std::mt19937_64 rng( bench::get_options().chain.seed );
+   auto inputs = fuzz_inputs( rng, 100000 );
+
+   uint32_t accepted = 0;
+   for( const auto& s : inputs ) {
+      const bool ok = legacy_eip55( s );
+      BOOST_TEST_CONTEXT( s ) BOOST_REQUIRE_EQUAL( ok, eosio::valid_eip55_checksum( s.c_str() ) );
+      accepted += ok;
+   }
+   BOOST_TEST_MESSAGE( accepted << " of " << inputs.size() << " fuzz inputs accepted" );
+}
+
+BOOST_AUTO_TEST_CASE( eip55_timing ) {
+   const auto iterations = bench::get_options().decoder_iterations;
+
+   const auto legacy  = validate_ns( legacy_eip55, checksummed, iterations );
+   const auto current = validate_ns( []( const std::string& s ) { return eosio::valid_eip55_checksum( s.c_str() ); },
+                                     checksummed, iterations );
+   std::cout << "eip55: " << iterations << " validations of checksummed addresses" << std::endl
+             << std::setw(10) << "legacy"   << std::setw(10) << std::fixed << std::setprecision(1) << legacy  << " ns" << std::endl
+             << std::setw(10) << "unrolled" << std::setw(10) << std::fixed << std::setprecision(1) << current << " ns" << std::endl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,272 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <boost/test/unit_test.hpp>
+#include <eosio/testing/tester.hpp>
+#include <eosio/chain/abi_serializer.hpp>
+#include <eosio/chain/contract_table_objects.hpp>
+#include "contracts.hpp"
+
+#include <fc/variant_object.hpp>
+
+using namespace eosio::testing;
+using namespace eosio;
+using namespace eosio::chain;
+using namespace fc;
+using namespace std;
+
+using mvo = fc::mutable_variant_object;
+
+/// one BTC token on bos.pegtoken, issued by `issuer` and backed by `acceptor`
+class bos_pegtoken_tester : public tester {
+public:
+
+   bos_pegtoken_tester() {
+      produce_blocks( 2 );
+
+      create_accounts( { N(bos.pegtoken), N(issuer), N(acceptor), N(auditor), N(partner), N(alice), N(bob), N(carol) } );
+      produce_blocks( 2 );
+
+      set_code( N(bos.pegtoken), contracts::pegtoken_wasm() );
+      set_abi( N(bos.pegtoken), contracts::pegtoken_abi().data() );
+
+      // withdraw and deposit move balances with inline transfers authorized by the sender
+      for( auto account : { N(acceptor), N(alice), N(bob), N(carol) } ) {
+         set_authority( account, config::active_name,
+                        authority( 1, {{get_public_key( account, "active" ), 1}},
+                                      {{{N(bos.pegtoken), config::eosio_code_name}, 1}} ),
+                        config::owner_name,
+                        { { account, config::owner_name } },
+                        { get_private_key( account, "owner" ) } );
+      }
+
+      produce_blocks();
+
+      const auto& accnt = control->db().get<account_object,by_name>( N(bos.pegtoken) );
+      abi_def abi;
+      BOOST_REQUIRE_EQUAL(abi_serializer::to_abi(accnt.abi, abi), true);
+      abi_ser.set_abi(abi, abi_serializer_max_time);
+   }
+
+   action_result push_action( const account_name& signer, const action_name &name, const variant_object &data ) {
+      string action_type_name = abi_ser.get_action_type(name);
+
+      action act;
+      act.account = N(bos.pegtoken);
+      act.name    = name;
+      act.data    = abi_ser.variant_to_binary( action_type_name, data,abi_serializer_max_time );
+
+      return base_tester::push_action( std::move(act), uint64_t(signer));
+   }
+
+   /// like push_action, but returns the trace so tests can see who was notified
+   transaction_trace_ptr push_action_trace( const account_name& signer, const action_name &name, const variant_object &data ) {
+      signed_transaction trx;
+      trx.actions.emplace_back( vector<permission_level>{{signer, config::active_name}}, N(bos.pegtoken), name,
+                                abi_ser.variant_to_binary( abi_ser.get_action_type(name), data, abi_serializer_max_time ) );
+      // vary the expiration so that repeating a read-only action within a block is not a duplicate
+      set_transaction_headers( trx, DEFAULT_EXPIRATION_DELTA + ++trace_nonce );
+      trx.sign( get_private_key( signer, "active" ), control->get_chain_id() );
+      return push_transaction( trx );
+   }
+
+   static vector<account_name> receivers( const transaction_trace_ptr& trace, const action_name& name ) {
+      vector<account_name> result;
+      for( const auto& at : trace->action_traces ) {
+         if( at.act.name == name ) {
+            result.push_back( at.receiver );
+         }
+      }
+      return result;
+   }
+
+   static uint64_t scope() {
+      return eosio::chain::symbol::from_string( "4,BTC" ).to_symbol_code().value;
+   }
+
+   fc::variant get_row( const name& scope_name, const name& table, uint64_t key, const string& type ) {
+      vector<char> data = get_row_by_account( N(bos.pegtoken), scope_name, table, key );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( type, data, abi_serializer_max_time );
+   }
+
+   fc::variant get_balance( account_name owner ) {
+      return get_row( owner, N(accounts), scope(), "account_ts" );
+   }
+
+   fc::variant get_withdraw( uint64_t id ) {
+      return get_row( name( scope() ), N(withdraws), id, "withdraw_ts" );
+   }
+
+   fc::variant get_deposit( uint64_t id ) {
+      return get_row( name( scope() ), N(deposits), id, "deposit_ts" );
+   }
+
+   fc::variant get_addr( account_name owner ) {
+      return get_row( name( scope() ), N(addrs), owner.to_uint64_t(), "addr_ts" );
+   }
+
+   /// turns the address assigned to `owner` into one assigned before addrkeys existed, which is
+   /// only found through the hash64 `addr` index, by removing its addrkeys row from the chain state
+   void drop_addrkey( account_name owner ) {
+      control->abort_block();
+      auto& db = const_cast<chainbase::database&>( control->db() );
+
+      const auto& table = db.get<table_id_object, by_code_scope_table>( boost::make_tuple( N(bos.pegtoken), name( scope() ), N(addrkeys) ) );
+      db.remove( db.get<key_value_object, by_scope_primary>( boost::make_tuple( table.id, owner.to_uint64_t() ) ) );
+      db.modify( table, []( auto& t ) { --t.count; } );
+
+      // the "key" index is secondary index 0 of the table
+      const auto& index = db.get<table_id_object, by_code_scope_table>( boost::make_tuple( N(bos.pegtoken), name( scope() ),
+                                                                                             name( N(addrkeys).to_uint64_t() & 0xFFFFFFFFFFFFFFF0ULL ) ) );
+      db.remove( db.get<index256_object, by_primary>( boost::make_tuple( index.id, owner.to_uint64_t() ) ) );
+      db.modify( index, []( auto& t ) { --t.count; } );
+   }
+
+   fc::variant get_pending( uint64_t id ) {
+      return get_row( name( scope() ), N(pendings), id, "pending_ts" );
+   }
+
+   uint32_t count_rows( const name& scope_name, const name& table ) {
+      const auto* tbl = control->db().find<table_id_object, by_code_scope_table>( boost::make_tuple( N(bos.pegtoken), scope_name, table ) );
+      return tbl ? tbl->count : 0;
+   }
+
+   /// creates BTC with the given address style, an auditor, and 10 BTC deposited to alice and bob
+   void setup_token( const string& address_style ) {
+      BOOST_REQUIRE_EQUAL( success(), push_action( N(bos.pegtoken), N(create), mvo()
+           ( "sym", "4,BTC" )
+           ( "issuer", "issuer" )
+           ( "acceptor", "acceptor" )
+           ( "address_style", address_style )
+           ( "organization", "" )
+           ( "website", "" )
+      ) );
+      BOOST_REQUIRE_EQUAL( success(), push_action( N(issuer), N(setlimit), mvo()
+           ( "max_limit", "5.0000 BTC" )
+           ( "min_limit", "0.0001 BTC" )
+           ( "total_limit", "10.0000 BTC" )
+           ( "frequency_limit", 10 )
+           ( "interval_limit", 0 )
+      ) );
+      BOOST_REQUIRE_EQUAL( success(), push_action( N(issuer), N(setauditor), mvo()
+           ( "sym_code", "BTC" )
+           ( "action", "add" )
+           ( "auditor", "auditor" )
+      ) );
+      BOOST_REQUIRE_EQUAL( success(), push_action( N(issuer), N(issue), mvo()
+           ( "quantity", "100.0000 BTC" )
+           ( "memo", "" )
+      ) );
+      BOOST_REQUIRE_EQUAL( success(), deposit( N(alice), asset::from_string("10.0000 BTC"), "" ) );
+      BOOST_REQUIRE_EQUAL( success(), deposit( N(bob), asset::from_string("10.0000 BTC"), "" ) );
+   }
+
+   action_result deposit( account_name to, asset quantity, const string& memo ) {
+      return push_action( N(acceptor), N(deposit), mvo()
+           ( "to", to )
+           ( "quantity", quantity )
+           ( "memo", memo )
+      );
+   }
+
+   action_result withdraw( account_name from, const string& to, asset quantity, const string& memo ) {
+      return push_action( from, N(withdraw), mvo()
+           ( "from", from )
+           ( "to", to )
+           ( "quantity", quantity )
+           ( "memo", memo )
+      );
+   }
+
+   action_result loadaddrs( account_name signer, const vector<string>& addresses ) {
+      return push_action( signer, N(loadaddrs), mvo()
+           ( "sym_code", "BTC" )
+           ( "addresses", addresses )
+      );
+   }
+
+   action_result applyaddr( account_name applicant, account_name to ) {
+      return push_action( applicant, N(applyaddr), mvo()
+           ( "applicant", applicant )
+           ( "sym_code", "BTC" )
+           ( "to", to )
+      );
+   }
+
+   action_result assignaddr( account_name to, const string& address ) {
+      return push_action( N(acceptor), N(assignaddr), mvo()
+           ( "sym_code", "BTC" )
+           ( "to", to )
+           ( "address", address )
+      );
+   }
+
+   action_result setratelimit( account_name signer, const string& burst, const string& sustained,
+                               uint32_t burst_count, uint32_t count_per_day ) {
+      return push_action( signer, N(setratelimit), mvo()
+           ( "sym_code", "BTC" )
+           ( "burst", burst )
+           ( "sustained", sustained )
+           ( "burst_count", burst_count )
+           ( "count_per_day", count_per_day )
+      );
+   }
+
+   /// what quota prints: the amount and number of withdraws `owner` has left
+   string quota( account_name owner ) {
+      auto trace = push_action_trace( N(carol), N(quota), mvo()
+           ( "sym_code", "BTC" )
+           ( "owner", owner )
+      );
+      return trace->action_traces[0].console;
+   }
+
+   fc::variant get_bucket( account_name owner ) {
+      return get_row( name( scope() ), N(buckets), owner.to_uint64_t(), "bucket_ts" );
+   }
+
+   action_result approvemany( account_name auditor, const fc::variants& trx_ids ) {
+      return push_action( auditor, N(approvemany), mvo()
+           ( "sym_code", "BTC" )
+           ( "auditor", auditor )
+           ( "trx_ids", trx_ids )
+      );
+   }
+
+   action_result auditor_action( const action_name& act, account_name auditor, const fc::variant& trx_id, const string& memo ) {
+      return push_action( auditor, act, mvo()
+           ( "sym_code", "BTC" )
+           ( "auditor", auditor )
+           ( "trx_id", trx_id )
+           ( "memo", memo )
+      );
+   }
+
+   static fc::variant deposit_info( account_name to, const string& quantity, const string& remote_trx_id ) {
+      return mvo()
+           ( "to", to )
+           ( "quantity", quantity )
+           ( "remote_trx_id", remote_trx_id )
+           ( "memo", "" );
+   }
+
+   action_result feedbackmany( account_name signer, const fc::variants& feedbacks ) {
+      return push_action( signer, N(feedbackmany), mvo()
+           ( "sym_code", "BTC" )
+           ( "feedbacks", feedbacks )
+      );
+   }
+
+   static fc::variant feedback_info( const fc::variant& trx_id, const string& remote_trx_id ) {
+      return mvo()
+           ( "trx_id", trx_id )
+           ( "remote_trx_id", remote_trx_id )
+           ( "memo", "" );
+   }
+
+   abi_serializer abi_ser;
+   uint32_t       trace_nonce = 0;
+};
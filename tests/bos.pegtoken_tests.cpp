@@ -0,0 +1,410 @@
+#include <boost/test/unit_test.hpp>
+#include <eosio/testing/tester.hpp>
+#include <eosio/chain/abi_serializer.hpp>
+
+#include <fc/variant_object.hpp>
+
+#include "bos.pegtoken_tester.hpp"
+
+#include <algorithm>
+
+BOOST_AUTO_TEST_SUITE(bos_pegtoken_tests)
+
+BOOST_FIXTURE_TEST_CASE( feedbackmany_tests, bos_pegtoken_tester ) try {
+
+   setup_token( "other" );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("1.0000 BTC"), "" ) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(bob), "remote-bob", asset::from_string("2.0000 BTC"), "" ) );
+
+   auto first = get_withdraw( 0 )["trx_id"];
+   auto second = get_withdraw( 1 )["trx_id"];
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "feedbacks is empty" ), feedbackmany( N(acceptor), {} ) );
+   BOOST_REQUIRE_EQUAL( error("missing authority of acceptor"),
+                        feedbackmany( N(alice), { feedback_info( first, "r0" ) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "param remote_trx_id too long, maximum length is 256" ),
+                        feedbackmany( N(acceptor), { feedback_info( first, "r0" ),
+                                                     feedback_info( second, string( 257, 'r' ) ) } ) );
+   auto long_memo = feedback_info( second, "r1" );
+   long_memo["memo"] = string( 257, 'm' );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "param f.memo too long, maximum length is 256" ),
+                        feedbackmany( N(acceptor), { feedback_info( first, "r0" ), long_memo } ) );
+   // the whole batch failed
+   BOOST_REQUIRE_EQUAL( 0, get_withdraw( 0 )["state"].as_uint64() );
+
+   BOOST_REQUIRE_EQUAL( success(), feedbackmany( N(acceptor), { feedback_info( first, "r0" ),
+                                                                feedback_info( second, string( 256, 'r' ) ) } ) );
+   BOOST_REQUIRE_EQUAL( 2, get_withdraw( 0 )["state"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( "r0", get_withdraw( 0 )["remote_trx_id"].as_string() );
+   BOOST_REQUIRE_EQUAL( 2, get_withdraw( 1 )["state"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 2, count_rows( name( scope() ), N(cleanups) ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "invalid state" ),
+                        feedbackmany( N(acceptor), { feedback_info( first, "r1" ) } ) );
+
+   // feedback goes through the same per-withdraw checks and updates
+   auto feedback = [&]( const fc::variant& trx_id, const string& remote_trx_id ) {
+      return push_action( N(acceptor), N(feedback), mvo()
+           ( "sym_code", "BTC" )
+           ( "trx_id", trx_id )
+           ( "remote_trx_id", remote_trx_id )
+           ( "memo", "" )
+      );
+   };
+   produce_block( fc::seconds(1) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("0.5000 BTC"), "" ) );
+   auto third = get_withdraw( 2 )["trx_id"];
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "invalid state" ), feedback( first, "r1" ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "param remote_trx_id too long, maximum length is 256" ),
+                        feedback( third, string( 257, 'r' ) ) );
+   BOOST_REQUIRE_EQUAL( success(), feedback( third, "r2" ) );
+   BOOST_REQUIRE_EQUAL( 2, get_withdraw( 2 )["state"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( "r2", get_withdraw( 2 )["remote_trx_id"].as_string() );
+   BOOST_REQUIRE_EQUAL( 3, count_rows( name( scope() ), N(cleanups) ) );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( cleanup_tests, bos_pegtoken_tester ) try {
+
+   setup_token( "other" );
+   auto setdelay = [&]( uint64_t delayday ) {
+      return push_action( N(issuer), N(setdelay), mvo()
+           ( "sym_code", "BTC" )
+           ( "delayday", delayday )
+      );
+   };
+   auto cleanup = [&]( uint64_t max ) {
+      return push_action( N(carol), N(cleanup), mvo()
+           ( "sym_code", "BTC" )
+           ( "max", max )
+      );
+   };
+   auto cleanups = [&]() { return count_rows( name( scope() ), N(cleanups) ); };
+
+   BOOST_REQUIRE_EQUAL( success(), setdelay( 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("1.0000 BTC"), "" ) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(bob), "remote-bob", asset::from_string("1.0000 BTC"), "" ) );
+   produce_block( fc::seconds(1) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("0.5000 BTC"), "" ) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(bob), "remote-bob", asset::from_string("0.5000 BTC"), "" ) );
+
+   fc::variants feedbacks;
+   for( uint64_t id = 0; id < 4; ++id ) {
+      feedbacks.push_back( feedback_info( get_withdraw( id )["trx_id"], "r" + std::to_string( id ) ) );
+   }
+   BOOST_REQUIRE_EQUAL( success(), feedbackmany( N(acceptor), feedbacks ) );
+   BOOST_REQUIRE_EQUAL( 4, cleanups() );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "max must be positive" ), cleanup( 0 ) );
+
+   // clear erases the two small withdraws but leaves their queue entries behind
+   BOOST_REQUIRE_EQUAL( success(), setdelay( 0 ) );
+   BOOST_REQUIRE_EQUAL( success(), push_action( N(issuer), N(setlimit), mvo()
+        ( "max_limit", "5.0000 BTC" )
+        ( "min_limit", "1.0000 BTC" )
+        ( "total_limit", "10.0000 BTC" )
+        ( "frequency_limit", 10 )
+        ( "interval_limit", 0 )
+   ) );
+   BOOST_REQUIRE_EQUAL( success(), push_action( N(acceptor), N(clear), mvo()
+        ( "sym_code", "BTC" )
+        ( "num", 10 )
+   ) );
+   BOOST_REQUIRE( get_withdraw( 2 ).is_null() );
+   BOOST_REQUIRE( get_withdraw( 3 ).is_null() );
+   BOOST_REQUIRE_EQUAL( 4, cleanups() );
+
+   // rmwithdraw takes its entry off the queue along with the withdraw
+   BOOST_REQUIRE_EQUAL( error("missing authority of bos.pegtoken/active"),
+                        push_action( N(carol), N(rmwithdraw), mvo()( "id", 1 )( "sym_code", "BTC" ) ) );
+   BOOST_REQUIRE_EQUAL( success(), push_action( N(bos.pegtoken), N(rmwithdraw), mvo()( "id", 1 )( "sym_code", "BTC" ) ) );
+   BOOST_REQUIRE( get_withdraw( 1 ).is_null() );
+   BOOST_REQUIRE_EQUAL( 3, cleanups() );
+
+   // nothing is removed before the delay the entries were queued with has passed
+   produce_block( fc::days(1) - fc::seconds(10) );
+   BOOST_REQUIRE_EQUAL( success(), cleanup( 10 ) );
+   BOOST_REQUIRE_EQUAL( 3, cleanups() );
+   BOOST_REQUIRE( !get_withdraw( 0 ).is_null() );
+
+   // matured entries go in due order, at most `max` per call; orphans are simply dropped
+   produce_block( fc::seconds(10) );
+   BOOST_REQUIRE_EQUAL( success(), cleanup( 2 ) );
+   BOOST_REQUIRE_EQUAL( 1, cleanups() );
+   BOOST_REQUIRE( get_withdraw( 0 ).is_null() );
+
+   BOOST_REQUIRE_EQUAL( success(), cleanup( 10 ) );
+   BOOST_REQUIRE_EQUAL( 0, cleanups() );
+   BOOST_REQUIRE_EQUAL( 0, count_rows( name( scope() ), N(withdraws) ) );
+   BOOST_REQUIRE_EQUAL( 0, count_rows( name( scope() ), N(pendings) ) );
+
+   // an empty queue is not an error
+   BOOST_REQUIRE_EQUAL( success(), cleanup( 1 ) );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( depositmany_tests, bos_pegtoken_tester ) try {
+
+   setup_token( "other" );
+   auto depositmany = [&]( account_name signer, const fc::variants& items ) {
+      return push_action( signer, N(depositmany), mvo()
+           ( "sym_code", "BTC" )
+           ( "items", items )
+      );
+   };
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "items is empty" ), depositmany( N(acceptor), {} ) );
+   BOOST_REQUIRE_EQUAL( error("missing authority of acceptor"),
+                        depositmany( N(alice), { deposit_info( N(carol), "1.0000 BTC", "d0" ) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "symbol precision mismatch" ),
+                        depositmany( N(acceptor), { deposit_info( N(carol), "1.00 BTC", "d0" ) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "to can't be acceptor" ),
+                        depositmany( N(acceptor), { deposit_info( N(carol), "1.0000 BTC", "d0" ),
+                                                    deposit_info( N(acceptor), "1.0000 BTC", "d1" ) } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "overdrawn balance" ),
+                        depositmany( N(acceptor), { deposit_info( N(carol), "81.0000 BTC", "d0" ) } ) );
+   BOOST_REQUIRE( get_balance( N(carol) ).is_null() );
+
+   const auto deposits_before = count_rows( name( scope() ), N(deposits) );
+   auto trace = push_action_trace( N(acceptor), N(depositmany), mvo()
+        ( "sym_code", "BTC" )
+        ( "items", fc::variants{ deposit_info( N(carol), "1.0000 BTC", "d0" ),
+                                 deposit_info( N(alice), "2.0000 BTC", "d1" ),
+                                 deposit_info( N(carol), "3.0000 BTC", "d2" ) } )
+   );
+
+   BOOST_REQUIRE_EQUAL( "4.0000 BTC", get_balance( N(carol) )["balance"].as_string() );
+   BOOST_REQUIRE_EQUAL( "12.0000 BTC", get_balance( N(alice) )["balance"].as_string() );
+   BOOST_REQUIRE_EQUAL( "74.0000 BTC", get_balance( N(acceptor) )["balance"].as_string() );
+   BOOST_REQUIRE_EQUAL( deposits_before + 3, count_rows( name( scope() ), N(deposits) ) );
+
+   // every record of the batch carries the id of the transaction that pushed it
+   for( uint64_t id = 2; id < 5; ++id ) {
+      BOOST_REQUIRE_EQUAL( trace->id.str(), get_deposit( id )["trx_id"].as_string() );
+   }
+   BOOST_REQUIRE( trace->id.str() != get_deposit( 1 )["trx_id"].as_string() );
+
+   // one notification per distinct party, no inline transfers
+   auto notified = receivers( trace, N(depositmany) );
+   std::sort( notified.begin(), notified.end() );
+   BOOST_REQUIRE( notified == ( vector<account_name>{ N(acceptor), N(alice), N(bos.pegtoken), N(carol) } ) );
+   BOOST_REQUIRE( receivers( trace, N(transfer) ).empty() );
+
+   // deposit checks and records its item the same way
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "to can't be acceptor" ),
+                        deposit( N(acceptor), asset::from_string("1.0000 BTC"), "" ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "symbol precision mismatch" ),
+                        deposit( N(carol), asset::from_string("1.00 BTC"), "" ) );
+   for( uint64_t id : { 0, 2 } ) {
+      auto d = get_deposit( id );
+      BOOST_REQUIRE_EQUAL( "acceptor", d["from"].as_string() );
+      BOOST_REQUIRE_EQUAL( id == 0 ? "alice" : "carol", d["to"].as_string() );
+      BOOST_REQUIRE_EQUAL( id == 0 ? "" : "d0", d["remote_trx_id"].as_string() );
+   }
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( address_pool_tests, bos_pegtoken_tester ) try {
+
+   setup_token( "bitcoin" );
+   BOOST_REQUIRE_EQUAL( success(), push_action( N(issuer), N(setpartner), mvo()
+        ( "sym_code", "BTC" )
+        ( "action", "add" )
+        ( "applicant", "partner" )
+   ) );
+
+   const string first  = "1A1zP1eP5QGefi2DMPTfTL5SLmv7DivfNa";
+   const string second = "1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2";
+   const string legacy = "3J98t1WpEZ73CNmQviecrnyiWrnqRhWNLy";
+   const string segwit = "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t4";
+
+   BOOST_REQUIRE_EQUAL( error("missing authority of acceptor"), loadaddrs( N(alice), { first } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "invalid bitcoin addr" ),
+                        loadaddrs( N(acceptor), { first, "1A1zP1eP5QGefi2DMPTfTL5SLmv7DivfNb" } ) );
+   BOOST_REQUIRE_EQUAL( success(), loadaddrs( N(acceptor), { first, second, segwit } ) );
+   BOOST_REQUIRE_EQUAL( 3, count_rows( name( scope() ), N(addrpool) ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "this address " + second + " is already in the pool" ),
+                        loadaddrs( N(acceptor), { second } ) );
+   // segwit keys ignore case
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "this address BC1QW508D6QEJXTDG4Y5R3ZARVARY0C5XW7KV8F3T4 is already in the pool" ),
+                        loadaddrs( N(acceptor), { "BC1QW508D6QEJXTDG4Y5R3ZARVARY0C5XW7KV8F3T4" } ) );
+
+   // applyaddr hands out the oldest pooled address at once
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "applicant dose not exist" ), applyaddr( N(alice), N(carol) ) );
+   BOOST_REQUIRE_EQUAL( success(), applyaddr( N(partner), N(carol) ) );
+   BOOST_REQUIRE_EQUAL( first, get_addr( N(carol) )["address"].as_string() );
+   BOOST_REQUIRE_EQUAL( 0, get_addr( N(carol) )["state"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 2, count_rows( name( scope() ), N(addrpool) ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "to account has applied for address already" ), applyaddr( N(partner), N(carol) ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "this address " + first + " has been assigned" ), loadaddrs( N(acceptor), { first } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "this address " + first + " has been assigned to carol" ), assignaddr( N(alice), first ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "this address " + second + " is already in the pool" ), assignaddr( N(alice), second ) );
+
+   // an address assigned before addrkeys existed is only known to the hash64 index
+   BOOST_REQUIRE_EQUAL( success(), assignaddr( N(alice), legacy ) );
+   drop_addrkey( N(alice) );
+   BOOST_REQUIRE_EQUAL( 1, count_rows( name( scope() ), N(addrkeys) ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "this address " + legacy + " has been assigned" ), loadaddrs( N(acceptor), { legacy } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "this address " + legacy + " has been assigned to alice" ), assignaddr( N(bob), legacy ) );
+
+   BOOST_REQUIRE_EQUAL( success(), applyaddr( N(partner), N(bob) ) );
+   BOOST_REQUIRE_EQUAL( second, get_addr( N(bob) )["address"].as_string() );
+   BOOST_REQUIRE_EQUAL( 1, count_rows( name( scope() ), N(addrpool) ) );
+
+   // a segwit address is keyed by its witness program, so its uppercase form is the same address
+   const string segwit = "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t4";
+   string upper = segwit;
+   std::transform( upper.begin(), upper.end(), upper.begin(), ::toupper );
+   BOOST_REQUIRE_EQUAL( success(), assignaddr( N(carol), segwit ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "this address " + upper + " has been assigned to carol" ), assignaddr( N(alice), upper ) );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( ratelimit_tests, bos_pegtoken_tester ) try {
+
+   setup_token( "other" );
+
+   BOOST_REQUIRE_EQUAL( error("missing authority of issuer"), setratelimit( N(alice), "3.0000 BTC", "8.6400 BTC", 2, 24 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "no rate limit set" ), setratelimit( N(issuer), "0.0000 BTC", "0.0000 BTC", 0, 0 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "burst_count must be positive" ), setratelimit( N(issuer), "3.0000 BTC", "8.6400 BTC", 0, 24 ) );
+   // refills 0.0001 BTC per second and one withdraw per hour
+   BOOST_REQUIRE_EQUAL( success(), setratelimit( N(issuer), "3.0000 BTC", "8.6400 BTC", 2, 24 ) );
+
+   // a user who never withdrew has a full bucket, without a row
+   BOOST_REQUIRE_EQUAL( "3.0000 BTC 2", quota( N(alice) ) );
+   BOOST_REQUIRE( get_bucket( N(alice) ).is_null() );
+
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("2.0000 BTC"), "w0" ) );
+   BOOST_REQUIRE_EQUAL( "1.0000 BTC 1", quota( N(alice) ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "exceed withdraw rate limit" ),
+                        withdraw( N(alice), "remote-alice", asset::from_string("1.5000 BTC"), "w1" ) );
+
+   // refill: sustained * elapsed / day, here one unit per second
+   produce_block( fc::seconds(1000) );
+   auto bucket = get_bucket( N(alice) );
+   BOOST_REQUIRE_EQUAL( 10000, bucket["amount"].as_int64() );
+   const auto now = ( control->head_block_time() + fc::milliseconds( config::block_interval_ms ) ).sec_since_epoch();
+   const auto elapsed = now - bucket["update_time"].as<fc::time_point_sec>().sec_since_epoch();
+   BOOST_REQUIRE_EQUAL( asset( 10000 + elapsed, symbol( 4, "BTC" ) ).to_string() + " 1", quota( N(alice) ) );
+
+   // count exhaustion: the amount is there, the second withdraw is not
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("0.1000 BTC"), "w2" ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "exceed withdraw frequency limit" ),
+                        withdraw( N(alice), "remote-alice", asset::from_string("0.1000 BTC"), "w3" ) );
+   produce_block( fc::seconds(3600) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("0.1000 BTC"), "w4" ) );
+
+   // the counter is capped at burst_count however long the user waited
+   produce_block( fc::days(3) );
+   BOOST_REQUIRE_EQUAL( "3.0000 BTC 2", quota( N(alice) ) );
+
+   // lowering burst caps a fuller bucket right away
+   BOOST_REQUIRE_EQUAL( success(), setratelimit( N(issuer), "0.5000 BTC", "8.6400 BTC", 2, 24 ) );
+   BOOST_REQUIRE_EQUAL( "0.5000 BTC 2", quota( N(alice) ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "exceed withdraw rate limit" ),
+                        withdraw( N(alice), "remote-alice", asset::from_string("0.6000 BTC"), "w5" ) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("0.5000 BTC"), "w6" ) );
+
+   // without limits withdraws fall back to the statistics window and drop the stale bucket
+   BOOST_REQUIRE_EQUAL( success(), setratelimit( N(issuer), "0.0000 BTC", "0.0000 BTC", 0, 0 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "no rate limit set" ),
+                        push_action( N(carol), N(quota), mvo()( "sym_code", "BTC" )( "owner", "alice" ) ) );
+   BOOST_REQUIRE( !get_bucket( N(alice) ).is_null() );
+   BOOST_REQUIRE( get_row( name( scope() ), N(statistics), N(alice).to_uint64_t(), "statistic_ts" ).is_null() );
+
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("1.0000 BTC"), "w7" ) );
+   BOOST_REQUIRE( get_bucket( N(alice) ).is_null() );
+   auto stat = get_row( name( scope() ), N(statistics), N(alice).to_uint64_t(), "statistic_ts" );
+   BOOST_REQUIRE_EQUAL( 1, stat["frequency"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( "1.0000 BTC", stat["total"].as_string() );
+   // and its checks apply again: with interval_limit 0, one withdraw per second
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "operate twice in interval_limit" ),
+                        withdraw( N(alice), "remote-alice", asset::from_string("0.1000 BTC"), "w8" ) );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( pending_queue_tests, bos_pegtoken_tester ) try {
+
+   setup_token( "other" );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("1.0000 BTC"), "w0" ) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(bob), "remote-bob", asset::from_string("1.0000 BTC"), "w1" ) );
+   produce_block( fc::seconds(1) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("1.0000 BTC"), "w2" ) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(bob), "remote-bob", asset::from_string("1.0000 BTC"), "w3" ) );
+   produce_block( fc::seconds(1) );
+   BOOST_REQUIRE_EQUAL( success(), withdraw( N(alice), "remote-alice", asset::from_string("0.5000 BTC"), "w4" ) );
+
+   // every withdraw is queued for the auditors
+   BOOST_REQUIRE_EQUAL( 5, count_rows( name( scope() ), N(pendings) ) );
+   vector<fc::variant> trx_ids;
+   for( uint64_t id = 0; id < 5; ++id ) {
+      auto pending = get_pending( id );
+      BOOST_REQUIRE_EQUAL( 0, pending["state"].as_uint64() );
+      BOOST_REQUIRE_EQUAL( true, pending["enable"].as_bool() );
+      trx_ids.push_back( get_withdraw( id )["trx_id"] );
+      BOOST_REQUIRE_EQUAL( trx_ids.back().as_string(), pending["trx_id"].as_string() );
+   }
+
+   // acceptor decisions update the queued state
+   BOOST_REQUIRE_EQUAL( success(), feedbackmany( N(acceptor), { feedback_info( trx_ids[0], "r0" ),
+                                                                feedback_info( trx_ids[4], "r4" ) } ) );
+   BOOST_REQUIRE_EQUAL( success(), push_action( N(acceptor), N(rollback), mvo()
+        ( "sym_code", "BTC" )
+        ( "trx_id", trx_ids[1] )
+        ( "memo", "" )
+   ) );
+   BOOST_REQUIRE_EQUAL( 2, get_pending( 0 )["state"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 5, get_pending( 1 )["state"].as_uint64() );
+
+   // auditor decisions take withdraws off the queue
+   BOOST_REQUIRE_EQUAL( success(), auditor_action( N(unapprove), N(auditor), trx_ids[2], "no" ) );
+   BOOST_REQUIRE( get_pending( 2 ).is_null() );
+   BOOST_REQUIRE_EQUAL( false, get_withdraw( 2 )["enable"].as_bool() );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "auditor not exist" ), approvemany( N(alice), { trx_ids[0] } ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "trx_ids is empty" ), approvemany( N(auditor), {} ) );
+   BOOST_REQUIRE_EQUAL( success(), approvemany( N(auditor), { trx_ids[0], trx_ids[3] } ) );
+   BOOST_REQUIRE( get_pending( 0 ).is_null() );
+   BOOST_REQUIRE( get_pending( 3 ).is_null() );
+   BOOST_REQUIRE_EQUAL( "auditor", get_withdraw( 3 )["auditor"].as_string() );
+   BOOST_REQUIRE_EQUAL( true, get_withdraw( 3 )["enable"].as_bool() );
+
+   // one decided withdraw fails the whole batch
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "already been approved/unapproved" ),
+                        approvemany( N(auditor), { trx_ids[1], trx_ids[2] } ) );
+   BOOST_REQUIRE( !get_pending( 1 ).is_null() );
+
+   BOOST_REQUIRE_EQUAL( success(), auditor_action( N(approve), N(auditor), trx_ids[1], "ok" ) );
+   BOOST_REQUIRE( get_pending( 1 ).is_null() );
+   BOOST_REQUIRE_EQUAL( "ok", get_withdraw( 1 )["msg"].as_string() );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "already been approved/unapproved" ),
+                        auditor_action( N(approve), N(auditor), trx_ids[1], "again" ) );
+
+   // clear deletes a settled withdraw together with its queue entry
+   BOOST_REQUIRE_EQUAL( success(), push_action( N(issuer), N(setdelay), mvo()
+        ( "sym_code", "BTC" )
+        ( "delayday", 0 )
+   ) );
+   BOOST_REQUIRE_EQUAL( success(), push_action( N(issuer), N(setlimit), mvo()
+        ( "max_limit", "5.0000 BTC" )
+        ( "min_limit", "1.0000 BTC" )
+        ( "total_limit", "10.0000 BTC" )
+        ( "frequency_limit", 10 )
+        ( "interval_limit", 0 )
+   ) );
+   BOOST_REQUIRE_EQUAL( success(), push_action( N(acceptor), N(clear), mvo()
+        ( "sym_code", "BTC" )
+        ( "num", 10 )
+   ) );
+   BOOST_REQUIRE( get_withdraw( 4 ).is_null() );
+   BOOST_REQUIRE( get_pending( 4 ).is_null() );
+   BOOST_REQUIRE( !get_withdraw( 0 ).is_null() );
+
+   // every withdraw was decided by an auditor or cleared, so nothing is left in the queue
+   BOOST_REQUIRE_EQUAL( 0, count_rows( name( scope() ), N(pendings) ) );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
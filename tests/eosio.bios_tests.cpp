@@ -0,0 +1,132 @@
+#include <boost/test/unit_test.hpp>
+#include <eosio/testing/tester.hpp>
+#include <eosio/chain/abi_serializer.hpp>
+#include <eosio/chain/resource_limits.hpp>
+
+#include <fc/variant_object.hpp>
+
+#include "contracts.hpp"
+
+using namespace eosio::testing;
+using namespace eosio;
+using namespace eosio::chain;
+using namespace fc;
+using namespace std;
+
+using mvo = fc::mutable_variant_object;
+
+class eosio_bios_tester : public tester {
+public:
+
+   eosio_bios_tester() {
+      create_accounts( { N(alice), N(bob), N(carol) } );
+      produce_block();
+
+      set_code( config::system_account_name, contracts::bios_wasm() );
+      set_abi( config::system_account_name, contracts::bios_abi().data() );
+      produce_blocks();
+
+      const auto& accnt = control->db().get<account_object,by_name>( config::system_account_name );
+      abi_def abi;
+      BOOST_REQUIRE_EQUAL(abi_serializer::to_abi(accnt.abi, abi), true);
+      abi_ser.set_abi(abi, abi_serializer_max_time);
+   }
+
+   action_result push_action( const account_name& signer, const action_name &name, const variant_object &data ) {
+      string action_type_name = abi_ser.get_action_type(name);
+
+      action act;
+      act.account = config::system_account_name;
+      act.name    = name;
+      act.data    = abi_ser.variant_to_binary( action_type_name, data, abi_serializer_max_time );
+
+      return base_tester::push_action( std::move(act), uint64_t(signer) );
+   }
+
+   bool is_privileged( account_name account ) {
+      return control->db().get<account_metadata_object,by_name>( account ).is_privileged();
+   }
+
+   void check_limits( account_name account, int64_t ram, int64_t net, int64_t cpu ) {
+      int64_t ram_bytes, net_weight, cpu_weight;
+      control->get_resource_limits_manager().get_account_limits( account, ram_bytes, net_weight, cpu_weight );
+      BOOST_REQUIRE_EQUAL( ram, ram_bytes );
+      BOOST_REQUIRE_EQUAL( net, net_weight );
+      BOOST_REQUIRE_EQUAL( cpu, cpu_weight );
+   }
+
+   static fc::variant limits( account_name account, int64_t ram, int64_t net, int64_t cpu ) {
+      return mvo()
+         ("account", account)
+         ("ram_bytes", ram)
+         ("net_weight", net)
+         ("cpu_weight", cpu);
+   }
+
+   abi_serializer abi_ser;
+};
+
+BOOST_AUTO_TEST_SUITE(eosio_bios_tests)
+
+BOOST_FIXTURE_TEST_CASE( setprivm_test, eosio_bios_tester ) try {
+
+   BOOST_REQUIRE_EQUAL( error("missing authority of eosio"),
+                        push_action( N(alice), N(setprivm), mvo()
+                           ("accounts", vector<account_name>{ N(alice) })
+                           ("is_priv", 1)
+                        ) );
+
+   BOOST_REQUIRE_EQUAL( success(), push_action( config::system_account_name, N(setprivm), mvo()
+                                      ("accounts", vector<account_name>{ N(alice), N(bob) })
+                                      ("is_priv", 1)
+                                   ) );
+   BOOST_REQUIRE( is_privileged( N(alice) ) );
+   BOOST_REQUIRE( is_privileged( N(bob) ) );
+   BOOST_REQUIRE( !is_privileged( N(carol) ) );
+
+   BOOST_REQUIRE_EQUAL( success(), push_action( config::system_account_name, N(setprivm), mvo()
+                                      ("accounts", vector<account_name>{ N(bob) })
+                                      ("is_priv", 0)
+                                   ) );
+   BOOST_REQUIRE( is_privileged( N(alice) ) );
+   BOOST_REQUIRE( !is_privileged( N(bob) ) );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( setalimitsm_test, eosio_bios_tester ) try {
+
+   BOOST_REQUIRE_EQUAL( error("missing authority of eosio"),
+                        push_action( N(alice), N(setalimitsm), mvo()
+                           ("limits", fc::variants{ limits( N(alice), 10000, 1, 1 ) })
+                        ) );
+
+   BOOST_REQUIRE_EQUAL( success(), push_action( config::system_account_name, N(setalimitsm), mvo()
+                                      ("limits", fc::variants{ limits( N(alice), 10000, 2, 3 ),
+                                                               limits( N(bob),   20000, 4, 5 ) })
+                                   ) );
+   check_limits( N(alice), 10000, 2, 3 );
+   check_limits( N(bob),   20000, 4, 5 );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( bootstrap_test, eosio_bios_tester ) try {
+
+   BOOST_REQUIRE_EQUAL( error("missing authority of eosio"),
+                        push_action( N(alice), N(bootstrap), mvo()
+                           ("privileged", vector<account_name>{ N(alice) })
+                           ("limits", fc::variants{})
+                        ) );
+
+   BOOST_REQUIRE_EQUAL( success(), push_action( config::system_account_name, N(bootstrap), mvo()
+                                      ("privileged", vector<account_name>{ N(alice) })
+                                      ("limits", fc::variants{ limits( N(bob),   30000, 6, 7 ),
+                                                               limits( N(carol), 40000, 8, 9 ) })
+                                   ) );
+   BOOST_REQUIRE( is_privileged( N(alice) ) );
+   BOOST_REQUIRE( !is_privileged( N(bob) ) );
+   check_limits( N(bob),   30000, 6, 7 );
+   check_limits( N(carol), 40000, 8, 9 );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
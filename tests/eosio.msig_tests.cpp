@@ -147,6 +147,29 @@ public:
 
    transaction reqauth( account_name from, const vector<permission_level>& auths, const fc::microseconds& max_serialization_time );
 
+   fc::variant get_approvals( account_name proposer, account_name proposal_name ) {
+      vector<char> data = get_row_by_account( N(eosio.msig), proposer, N(approvals2), proposal_name );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "approvals_info", data, abi_serializer_max_time );
+   }
+
+   fc::variant get_proposal( account_name proposer, account_name proposal_name ) {
+      vector<char> data = get_row_by_account( N(eosio.msig), proposer, N(proposal), proposal_name );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "proposal", data, abi_serializer_max_time );
+   }
+
+   uint32_t count_rows( account_name scope, account_name table ) {
+      const auto* tbl = control->db().find<table_id_object, by_code_scope_table>( boost::make_tuple( N(eosio.msig), scope, table ) );
+      return tbl ? tbl->count : 0;
+   }
+
+   static vector<account_name> approval_actors( const fc::variant& approvals ) {
+      vector<account_name> actors;
+      for( const auto& a : approvals.get_array() ) {
+         actors.push_back( a["level"]["actor"].as<account_name>() );
+      }
+      return actors;
+   }
+
    abi_serializer abi_ser;
 };
 
@@ -881,6 +904,7 @@ BOOST_FIXTURE_TEST_CASE( approve_with_hash, eosio_msig_tester ) try {
                   ("trx",           trx)
                   ("requested", vector<permission_level>{{ N(alice), config::active_name }})
    );
+   BOOST_REQUIRE_EQUAL( trx_hash, get_proposal( N(alice), N(first) )["trx_hash"].as<fc::sha256>() );
 
    //fail to approve with incorrect hash
    BOOST_REQUIRE_EXCEPTION( push_action( N(alice), N(approve), mvo()
@@ -889,8 +913,8 @@ BOOST_FIXTURE_TEST_CASE( approve_with_hash, eosio_msig_tester ) try {
                                           ("level",         permission_level{ N(alice), config::active_name })
                                           ("proposal_hash", not_trx_hash)
                             ),
-                            eosio::chain::crypto_api_exception,
-                            fc_exception_message_is("hash mismatch")
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("hash mismatch")
    );
 
    //approve and execute
@@ -951,9 +975,403 @@ BOOST_FIXTURE_TEST_CASE( switch_proposal_and_fail_approve_with_hash, eosio_msig_
                                           ("level",         permission_level{ N(alice), config::active_name })
                                           ("proposal_hash", trx1_hash)
                             ),
-                            eosio::chain::crypto_api_exception,
-                            fc_exception_message_is("hash mismatch")
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("hash mismatch")
+   );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( approvals_kept_sorted, eosio_msig_tester ) try {
+   auto trx = reqauth("alice", vector<permission_level>{ { N(alice), config::active_name }, { N(bob), config::active_name }, { N(carol), config::active_name } }, abi_serializer_max_time );
+   push_action( N(alice), N(propose), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("trx",           trx)
+                  ("requested", vector<permission_level>{ { N(carol), config::active_name }, { N(alice), config::active_name }, { N(bob), config::active_name } })
+   );
+
+   auto apps = get_approvals( N(alice), N(first) );
+   BOOST_REQUIRE_EQUAL( 2, apps["version"].as<uint8_t>() );
+   BOOST_REQUIRE( approval_actors( apps["requested_approvals"] ) == vector<account_name>({ N(alice), N(bob), N(carol) }) );
+
+   //approve out of order
+   for( auto actor : { N(carol), N(alice), N(bob) } ) {
+      push_action( actor, N(approve), mvo()
+                     ("proposer",      "alice")
+                     ("proposal_name", "first")
+                     ("level",         permission_level{ actor, config::active_name })
+      );
+   }
+   apps = get_approvals( N(alice), N(first) );
+   BOOST_REQUIRE_EQUAL( 0, apps["requested_approvals"].get_array().size() );
+   BOOST_REQUIRE( approval_actors( apps["provided_approvals"] ) == vector<account_name>({ N(alice), N(bob), N(carol) }) );
+
+   push_action( N(bob), N(unapprove), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(bob), config::active_name })
+   );
+   BOOST_REQUIRE_EXCEPTION( push_action( N(bob), N(unapprove), mvo()
+                                          ("proposer",      "alice")
+                                          ("proposal_name", "first")
+                                          ("level",         permission_level{ N(bob), config::active_name })
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("no approval previously granted")
+   );
+   apps = get_approvals( N(alice), N(first) );
+   BOOST_REQUIRE( approval_actors( apps["requested_approvals"] ) == vector<account_name>({ N(bob) }) );
+   BOOST_REQUIRE( approval_actors( apps["provided_approvals"] ) == vector<account_name>({ N(alice), N(carol) }) );
+
+   //fail because approval by bob is missing
+   BOOST_REQUIRE_EXCEPTION( push_action( N(alice), N(exec), mvo()
+                                          ("proposer",      "alice")
+                                          ("proposal_name", "first")
+                                          ("executer",      "alice")
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("transaction authorization failed")
+   );
+
+   push_action( N(bob), N(approve), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(bob), config::active_name })
+   );
+
+   transaction_trace_ptr trace;
+   control->applied_transaction.connect([&]( const transaction_trace_ptr& t) { if (t->scheduled) { trace = t; } } );
+   push_action( N(alice), N(exec), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("executer",      "alice")
+   );
+
+   BOOST_REQUIRE( bool(trace) );
+   BOOST_REQUIRE_EQUAL( transaction_receipt::executed, trace->receipt->status );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( approve_many, eosio_msig_tester ) try {
+   auto trx1 = reqauth("alice", {permission_level{N(alice), config::active_name}}, abi_serializer_max_time );
+   auto trx2 = reqauth("bob", vector<permission_level>{ { N(alice), config::active_name }, { N(bob), config::active_name } }, abi_serializer_max_time );
+   auto trx2_hash = fc::sha256::hash( trx2 );
+
+   push_action( N(alice), N(propose), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("trx",           trx1)
+                  ("requested", vector<permission_level>{{ N(alice), config::active_name }})
+   );
+   push_action( N(bob), N(propose), mvo()
+                  ("proposer",      "bob")
+                  ("proposal_name", "second")
+                  ("trx",           trx2)
+                  ("requested", vector<permission_level>{ { N(alice), config::active_name }, { N(bob), config::active_name } })
+   );
+
+   //fail as a whole when one of the proposals does not request the level
+   BOOST_REQUIRE_EXCEPTION( push_action( N(bob), N(approvemany), mvo()
+                                          ("level",     permission_level{ N(bob), config::active_name })
+                                          ("proposals", fc::variants({
+                                             mvo()("proposer", "alice")("proposal_name", "first"),
+                                             mvo()("proposer", "bob")("proposal_name", "second")
+                                          }))
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("approval is not on the list of requested approvals")
+   );
+
+   //fail with a hash meant for another proposal
+   BOOST_REQUIRE_EXCEPTION( push_action( N(alice), N(approvemany), mvo()
+                                          ("level",     permission_level{ N(alice), config::active_name })
+                                          ("proposals", fc::variants({
+                                             mvo()("proposer", "alice")("proposal_name", "first")("proposal_hash", trx2_hash)
+                                          }))
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("hash mismatch")
+   );
+
+   push_action( N(alice), N(approvemany), mvo()
+                  ("level",     permission_level{ N(alice), config::active_name })
+                  ("proposals", fc::variants({
+                     mvo()("proposer", "alice")("proposal_name", "first"),
+                     mvo()("proposer", "bob")("proposal_name", "second")("proposal_hash", trx2_hash)
+                  }))
+   );
+   push_action( N(bob), N(approve), mvo()
+                  ("proposer",      "bob")
+                  ("proposal_name", "second")
+                  ("level",         permission_level{ N(bob), config::active_name })
+   );
+
+   vector<transaction_trace_ptr> traces;
+   control->applied_transaction.connect([&]( const transaction_trace_ptr& t) { if (t->scheduled) { traces.push_back( t ); } } );
+   push_action( N(alice), N(exec), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("executer",      "alice")
+   );
+   push_action( N(bob), N(exec), mvo()
+                  ("proposer",      "bob")
+                  ("proposal_name", "second")
+                  ("executer",      "bob")
+   );
+
+   BOOST_REQUIRE_EQUAL( 2, traces.size() );
+   for( const auto& t : traces ) {
+      BOOST_REQUIRE_EQUAL( transaction_receipt::executed, t->receipt->status );
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( invalidate_among_many_approvers, eosio_msig_tester ) try {
+   vector<permission_level> perms{ { N(alice), config::active_name }, { N(bob), config::active_name }, { N(carol), config::active_name } };
+   auto trx = reqauth("alice", perms, abi_serializer_max_time );
+   push_action( N(alice), N(propose), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("trx",           trx)
+                  ("requested",     perms)
+   );
+
+   //carol's invalidation predates her approval, so it does not void it
+   push_action( N(carol), N(invalidate), mvo()
+                  ("account",      "carol")
+   );
+   for( const auto& level : perms ) {
+      push_action( level.actor, N(approve), mvo()
+                     ("proposer",      "alice")
+                     ("proposal_name", "first")
+                     ("level",         level)
+      );
+   }
+
+   //bob's invalidation voids his approval
+   push_action( N(bob), N(invalidate), mvo()
+                  ("account",      "bob")
+   );
+   BOOST_REQUIRE_EXCEPTION( push_action( N(alice), N(exec), mvo()
+                                          ("proposer",      "alice")
+                                          ("proposal_name", "first")
+                                          ("executer",      "alice")
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("transaction authorization failed")
+   );
+
+   push_action( N(bob), N(unapprove), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(bob), config::active_name })
+   );
+   push_action( N(bob), N(approve), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(bob), config::active_name })
+   );
+
+   transaction_trace_ptr trace;
+   control->applied_transaction.connect([&]( const transaction_trace_ptr& t) { if (t->scheduled) { trace = t; } } );
+   push_action( N(alice), N(exec), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("executer",      "alice")
+   );
+
+   BOOST_REQUIRE( bool(trace) );
+   BOOST_REQUIRE_EQUAL( transaction_receipt::executed, trace->receipt->status );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( big_transaction_chunked, eosio_msig_tester ) try {
+   vector<permission_level> perm = { { N(alice), config::active_name }, { N(bob), config::active_name } };
+   auto wasm = contracts::util::exchange_wasm();
+
+   variant pretty_trx = fc::mutable_variant_object()
+      ("expiration", "2020-01-01T00:30")
+      ("ref_block_num", 2)
+      ("ref_block_prefix", 3)
+      ("max_net_usage_words", 0)
+      ("max_cpu_usage_ms", 0)
+      ("delay_sec", 0)
+      ("actions", fc::variants({
+            fc::mutable_variant_object()
+               ("account", name(config::system_account_name))
+               ("name", "setcode")
+               ("authorization", perm)
+               ("data", fc::mutable_variant_object()
+                ("account", "alice")
+                ("vmtype", 0)
+                ("vmversion", 0)
+                ("code", bytes( wasm.begin(), wasm.end() ))
+               )
+               })
+      );
+
+   transaction trx;
+   abi_serializer::from_variant(pretty_trx, trx, get_resolver(), abi_serializer_max_time);
+   auto packed = fc::raw::pack( trx );
+   auto trx_hash = fc::sha256::hash( trx );
+   const uint32_t chunk_size = 16 * 1024;
+   BOOST_REQUIRE( packed.size() > chunk_size );
+   const uint32_t extra_chunks = ( packed.size() - 1 ) / chunk_size;
+
+   push_action( N(alice), N(propose), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("trx",           trx)
+                  ("requested", perm)
+   );
+
+   //only the first chunk and the hash live in the proposal row
+   auto prop = get_proposal( N(alice), N(first) );
+   BOOST_REQUIRE_EQUAL( chunk_size, prop["packed_transaction"].as<bytes>().size() );
+   BOOST_REQUIRE_EQUAL( packed.size(), prop["trx_size"].as<uint32_t>() );
+   BOOST_REQUIRE_EQUAL( trx_hash, prop["trx_hash"].as<fc::sha256>() );
+   BOOST_REQUIRE_EQUAL( extra_chunks, count_rows( N(alice), N(propchunks) ) );
+
+   //readprop reassembles the chunks in index order
+   auto read_trace = push_action( N(carol), N(readprop), mvo()
+                                    ("proposer",      "alice")
+                                    ("proposal_name", "first")
+   );
+   BOOST_REQUIRE_EQUAL( fc::to_hex( packed.data(), packed.size() ), read_trace->action_traces[0].console );
+
+   //cancel drops the chunks too
+   push_action( N(alice), N(cancel), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("canceler",      "alice")
+   );
+   BOOST_REQUIRE_EQUAL( 0, count_rows( N(alice), N(propchunks) ) );
+
+   push_action( N(alice), N(propose), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("trx",           trx)
+                  ("requested", perm)
+   );
+
+   BOOST_REQUIRE_EXCEPTION( push_action( N(alice), N(approve), mvo()
+                                          ("proposer",      "alice")
+                                          ("proposal_name", "first")
+                                          ("level",         permission_level{ N(alice), config::active_name })
+                                          ("proposal_hash", fc::sha256::hash( trx_hash ))
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("hash mismatch")
+   );
+   push_action( N(alice), N(approve), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(alice), config::active_name })
+                  ("proposal_hash", trx_hash)
+   );
+   push_action( N(bob), N(approve), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(bob), config::active_name })
+                  ("proposal_hash", trx_hash)
+   );
+
+   transaction_trace_ptr trace;
+   control->applied_transaction.connect([&]( const transaction_trace_ptr& t) { if (t->scheduled) { trace = t; } } );
+   push_action( N(alice), N(exec), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("executer",      "alice")
    );
+
+   BOOST_REQUIRE( bool(trace) );
+   BOOST_REQUIRE_EQUAL( 1, trace->action_traces.size() );
+   BOOST_REQUIRE_EQUAL( transaction_receipt::executed, trace->receipt->status );
+   BOOST_REQUIRE_EQUAL( 0, count_rows( N(alice), N(propchunks) ) );
+   BOOST_REQUIRE( get_proposal( N(alice), N(first) ).is_null() );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( gc_expired_proposals, eosio_msig_tester ) try {
+   auto trx = reqauth("alice", {permission_level{N(alice), config::active_name}}, abi_serializer_max_time );
+
+   for( auto proposal_name : { N(first), N(second) } ) {
+      push_action( N(alice), N(propose), mvo()
+                     ("proposer",      "alice")
+                     ("proposal_name", proposal_name)
+                     ("trx",           trx)
+                     ("requested", vector<permission_level>{{ N(alice), config::active_name }})
+      );
+   }
+   BOOST_REQUIRE_EQUAL( 2, count_rows( N(eosio.msig), N(expiries) ) );
+
+   BOOST_REQUIRE_EXCEPTION( push_action( N(carol), N(gc), mvo()("max", 0) ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("max must be positive")
+   );
+
+   //cancel drops its expiry entry
+   push_action( N(alice), N(cancel), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "second")
+                  ("canceler",      "alice")
+   );
+   BOOST_REQUIRE_EQUAL( 1, count_rows( N(eosio.msig), N(expiries) ) );
+
+   //nothing has expired yet
+   push_action( N(carol), N(gc), mvo()("max", 10) );
+   BOOST_REQUIRE( !get_proposal( N(alice), N(first) ).is_null() );
+   BOOST_REQUIRE( !get_approvals( N(alice), N(first) ).is_null() );
+
+   produce_block( fc::minutes(31) );
+   produce_block();
+
+   //anyone can collect an expired proposal
+   push_action( N(carol), N(gc), mvo()("max", 10) );
+   BOOST_REQUIRE( get_proposal( N(alice), N(first) ).is_null() );
+   BOOST_REQUIRE( get_approvals( N(alice), N(first) ).is_null() );
+   BOOST_REQUIRE_EQUAL( 0, count_rows( N(eosio.msig), N(expiries) ) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( canexec_dry_run, eosio_msig_tester ) try {
+   auto trx = reqauth("alice", vector<permission_level>{ { N(alice), config::active_name }, { N(bob), config::active_name } }, abi_serializer_max_time );
+   push_action( N(alice), N(propose), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("trx",           trx)
+                  ("requested", vector<permission_level>{ { N(alice), config::active_name }, { N(bob), config::active_name } })
+   );
+
+   auto canexec_status = [&]() {
+      auto trace = push_action( N(carol), N(canexec), mvo()
+                                  ("proposer",      "alice")
+                                  ("proposal_name", "first")
+      );
+      return trace->action_traces[0].console;
+   };
+
+   BOOST_REQUIRE_EQUAL( "unauthorized", canexec_status() );
+
+   push_action( N(alice), N(approve), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(alice), config::active_name })
+   );
+   BOOST_REQUIRE_EQUAL( "unauthorized", canexec_status() );
+
+   push_action( N(bob), N(approve), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(bob), config::active_name })
+   );
+   BOOST_REQUIRE_EQUAL( "executable", canexec_status() );
+
+   //dry run leaves the proposal and its approvals in place
+   BOOST_REQUIRE( !get_proposal( N(alice), N(first) ).is_null() );
+   BOOST_REQUIRE_EQUAL( 2, get_approvals( N(alice), N(first) )["provided_approvals"].get_array().size() );
+
+   //a later invalidation voids bob's approval
+   push_action( N(bob), N(invalidate), mvo()("account", "bob") );
+   BOOST_REQUIRE_EQUAL( "unauthorized", canexec_status() );
+
+   produce_block( fc::minutes(31) );
+   produce_block();
+   BOOST_REQUIRE_EQUAL( "expired", canexec_status() );
 } FC_LOG_AND_RETHROW()
 
 BOOST_AUTO_TEST_SUITE_END()
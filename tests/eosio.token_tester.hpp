@@ -0,0 +1,183 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <boost/test/unit_test.hpp>
+#include <eosio/testing/tester.hpp>
+#include <eosio/chain/abi_serializer.hpp>
+#include "contracts.hpp"
+
+#include <fc/variant_object.hpp>
+
+using namespace eosio::testing;
+using namespace eosio;
+using namespace eosio::chain;
+using namespace fc;
+using namespace std;
+
+using mvo = fc::mutable_variant_object;
+
+class eosio_token_tester : public tester {
+public:
+
+   eosio_token_tester() {
+      produce_blocks( 2 );
+
+      create_accounts( { N(alice), N(bob), N(carol), N(eosio.token) } );
+      produce_blocks( 2 );
+
+      set_code( N(eosio.token), contracts::token_wasm() );
+      set_abi( N(eosio.token), contracts::token_abi().data() );
+
+      produce_blocks();
+
+      const auto& accnt = control->db().get<account_object,by_name>( N(eosio.token) );
+      abi_def abi;
+      BOOST_REQUIRE_EQUAL(abi_serializer::to_abi(accnt.abi, abi), true);
+      abi_ser.set_abi(abi, abi_serializer_max_time);
+   }
+
+   action_result push_action( const account_name& signer, const action_name &name, const variant_object &data ) {
+      string action_type_name = abi_ser.get_action_type(name);
+
+      action act;
+      act.account = N(eosio.token);
+      act.name    = name;
+      act.data    = abi_ser.variant_to_binary( action_type_name, data,abi_serializer_max_time );
+
+      return base_tester::push_action( std::move(act), uint64_t(signer));
+   }
+
+   fc::variant get_stats( const string& symbolname )
+   {
+      auto symb = eosio::chain::symbol::from_string(symbolname);
+      auto symbol_code = symb.to_symbol_code().value;
+      vector<char> data = get_row_by_account( N(eosio.token), symbol_code, N(stat), symbol_code );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "currency_stats", data, abi_serializer_max_time );
+   }
+
+   fc::variant get_account( account_name acc, const string& symbolname)
+   {
+      auto symb = eosio::chain::symbol::from_string(symbolname);
+      auto symbol_code = symb.to_symbol_code().value;
+      vector<char> data = get_row_by_account( N(eosio.token), acc, N(accounts), symbol_code );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "account", data, abi_serializer_max_time );
+   }
+
+   action_result create( account_name issuer,
+                asset        maximum_supply ) {
+
+      return push_action( N(eosio.token), N(create), mvo()
+           ( "issuer", issuer)
+           ( "maximum_supply", maximum_supply)
+      );
+   }
+
+   action_result issue( account_name issuer, account_name to, asset quantity, string memo ) {
+      return push_action( issuer, N(issue), mvo()
+           ( "to", to)
+           ( "quantity", quantity)
+           ( "memo", memo)
+      );
+   }
+
+   action_result retire( account_name issuer, asset quantity, string memo ) {
+      return push_action( issuer, N(retire), mvo()
+           ( "quantity", quantity)
+           ( "memo", memo)
+      );
+
+   }
+
+   action_result transfer( account_name from,
+                  account_name to,
+                  asset        quantity,
+                  string       memo ) {
+      return push_action( from, N(transfer), mvo()
+           ( "from", from)
+           ( "to", to)
+           ( "quantity", quantity)
+           ( "memo", memo)
+      );
+   }
+
+   action_result transferseq( account_name from,
+                              account_name to,
+                              asset        quantity,
+                              string       memo,
+                              uint64_t     seq ) {
+      return push_action( from, N(transferseq), mvo()
+           ( "from", from)
+           ( "to", to)
+           ( "quantity", quantity)
+           ( "memo", memo)
+           ( "seq", seq)
+      );
+   }
+
+   action_result open( account_name owner,
+                       const string& symbolname,
+                       account_name ram_payer    ) {
+      return push_action( ram_payer, N(open), mvo()
+           ( "owner", owner )
+           ( "symbol", symbolname )
+           ( "ram_payer", ram_payer )
+      );
+   }
+
+   action_result close( account_name owner,
+                        const string& symbolname ) {
+      return push_action( owner, N(close), mvo()
+           ( "owner", owner )
+           ( "symbol", "0,CERO" )
+      );
+   }
+
+   action_result setautoclose( account_name issuer,
+                               const string& symbolname,
+                               bool          enabled ) {
+      return push_action( issuer, N(setautoclose), mvo()
+           ( "symbol", symbolname )
+           ( "enabled", enabled )
+      );
+   }
+
+   action_result sweepzero( account_name signer,
+                            const string& symbolname,
+                            const vector<account_name>& owners ) {
+      return push_action( signer, N(sweepzero), mvo()
+           ( "symbol", symbolname )
+           ( "owners", owners )
+      );
+   }
+
+   action_result addorder( account_name from,
+                           account_name to,
+                           asset        quantity,
+                           uint32_t     period,
+                           fc::time_point_sec first_due ) {
+      return push_action( from, N(addorder), mvo()
+           ( "from", from )
+           ( "to", to )
+           ( "quantity", quantity )
+           ( "period", period )
+           ( "first_due", first_due )
+      );
+   }
+
+   action_result cancelorder( account_name signer, uint64_t id ) {
+      return push_action( signer, N(cancelorder), mvo()
+           ( "id", id )
+      );
+   }
+
+   action_result execdue( account_name signer, uint32_t max ) {
+      return push_action( signer, N(execdue), mvo()
+           ( "max", max )
+      );
+   }
+
+   abi_serializer abi_ser;
+};
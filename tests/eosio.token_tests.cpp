@@ -1,7 +1,9 @@
 #include <boost/test/unit_test.hpp>
 #include <eosio/testing/tester.hpp>
 #include <eosio/chain/abi_serializer.hpp>
+#include <eosio/chain/resource_limits.hpp>
 #include "eosio.system_tester.hpp"
+#include "eosio.token_tester.hpp"
 
 #include "Runtime/Runtime.h"
 
@@ -16,111 +18,6 @@ using namespace std;
 
 using mvo = fc::mutable_variant_object;
 
-class eosio_token_tester : public tester {
-public:
-
-   eosio_token_tester() {
-      produce_blocks( 2 );
-
-      create_accounts( { N(alice), N(bob), N(carol), N(eosio.token) } );
-      produce_blocks( 2 );
-
-      set_code( N(eosio.token), contracts::token_wasm() );
-      set_abi( N(eosio.token), contracts::token_abi().data() );
-
-      produce_blocks();
-
-      const auto& accnt = control->db().get<account_object,by_name>( N(eosio.token) );
-      abi_def abi;
-      BOOST_REQUIRE_EQUAL(abi_serializer::to_abi(accnt.abi, abi), true);
-      abi_ser.set_abi(abi, abi_serializer_max_time);
-   }
-
-   action_result push_action( const account_name& signer, const action_name &name, const variant_object &data ) {
-      string action_type_name = abi_ser.get_action_type(name);
-
-      action act;
-      act.account = N(eosio.token);
-      act.name    = name;
-      act.data    = abi_ser.variant_to_binary( action_type_name, data,abi_serializer_max_time );
-
-      return base_tester::push_action( std::move(act), uint64_t(signer));
-   }
-
-   fc::variant get_stats( const string& symbolname )
-   {
-      auto symb = eosio::chain::symbol::from_string(symbolname);
-      auto symbol_code = symb.to_symbol_code().value;
-      vector<char> data = get_row_by_account( N(eosio.token), symbol_code, N(stat), symbol_code );
-      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "currency_stats", data, abi_serializer_max_time );
-   }
-
-   fc::variant get_account( account_name acc, const string& symbolname)
-   {
-      auto symb = eosio::chain::symbol::from_string(symbolname);
-      auto symbol_code = symb.to_symbol_code().value;
-      vector<char> data = get_row_by_account( N(eosio.token), acc, N(accounts), symbol_code );
-      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "account", data, abi_serializer_max_time );
-   }
-
-   action_result create( account_name issuer,
-                asset        maximum_supply ) {
-
-      return push_action( N(eosio.token), N(create), mvo()
-           ( "issuer", issuer)
-           ( "maximum_supply", maximum_supply)
-      );
-   }
-
-   action_result issue( account_name issuer, account_name to, asset quantity, string memo ) {
-      return push_action( issuer, N(issue), mvo()
-           ( "to", to)
-           ( "quantity", quantity)
-           ( "memo", memo)
-      );
-   }
-
-   action_result retire( account_name issuer, asset quantity, string memo ) {
-      return push_action( issuer, N(retire), mvo()
-           ( "quantity", quantity)
-           ( "memo", memo)
-      );
-
-   }
-
-   action_result transfer( account_name from,
-                  account_name to,
-                  asset        quantity,
-                  string       memo ) {
-      return push_action( from, N(transfer), mvo()
-           ( "from", from)
-           ( "to", to)
-           ( "quantity", quantity)
-           ( "memo", memo)
-      );
-   }
-
-   action_result open( account_name owner,
-                       const string& symbolname,
-                       account_name ram_payer    ) {
-      return push_action( ram_payer, N(open), mvo()
-           ( "owner", owner )
-           ( "symbol", symbolname )
-           ( "ram_payer", ram_payer )
-      );
-   }
-
-   action_result close( account_name owner,
-                        const string& symbolname ) {
-      return push_action( owner, N(close), mvo()
-           ( "owner", owner )
-           ( "symbol", "0,CERO" )
-      );
-   }
-
-   abi_serializer abi_ser;
-};
-
 BOOST_AUTO_TEST_SUITE(eosio_token_tests)
 
 BOOST_FIXTURE_TEST_CASE( create_tests, eosio_token_tester ) try {
@@ -412,4 +309,258 @@ BOOST_FIXTURE_TEST_CASE( close_tests, eosio_token_tester ) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE( standing_order_tests, eosio_token_tester ) try {
+
+   auto token = create( N(alice), asset::from_string("1000 CERO"));
+   BOOST_REQUIRE_EQUAL( success(), issue( N(alice), N(alice), asset::from_string("250 CERO"), "issue" ) );
+
+   auto first_due = fc::time_point_sec( control->head_block_time() + fc::seconds(10) );
+   BOOST_REQUIRE_EQUAL( success(), addorder( N(alice), N(bob), asset::from_string("100 CERO"), 60, first_due ) );
+
+   // recipient row is opened by the order itself
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "0 CERO")
+   );
+
+   // nothing due yet
+   BOOST_REQUIRE_EQUAL( success(), execdue( N(carol), 10 ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "0 CERO")
+   );
+
+   produce_block( fc::seconds(10) );
+   auto trace = base_tester::push_action( N(eosio.token), N(execdue), N(carol), mvo()( "max", 10 ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "0,CERO"), mvo()
+      ("balance", "150 CERO")
+   );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "100 CERO")
+   );
+
+   // the payment notifies both sides, without eosio.token acting on its own authority
+   vector<account_name> notified;
+   for( const auto& at : trace->action_traces ) {
+      BOOST_REQUIRE_EQUAL( "execdue", at.act.name.to_string() );
+      notified.push_back( at.receiver );
+   }
+   BOOST_REQUIRE( notified == vector<account_name>({ N(eosio.token), N(alice), N(bob) }) );
+
+   // already settled for this period
+   BOOST_REQUIRE_EQUAL( success(), execdue( N(carol), 10 ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "100 CERO")
+   );
+
+   // two periods behind: the second one is not covered and gets skipped
+   produce_block( fc::seconds(120) );
+   BOOST_REQUIRE_EQUAL( success(), execdue( N(carol), 10 ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "0,CERO"), mvo()
+      ("balance", "50 CERO")
+   );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "200 CERO")
+   );
+
+   // the skipped order moved past now, so funding it does not pay the missed period
+   BOOST_REQUIRE_EQUAL( success(), issue( N(alice), N(alice), asset::from_string("50 CERO"), "issue" ) );
+   BOOST_REQUIRE_EQUAL( success(), execdue( N(carol), 10 ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "200 CERO")
+   );
+   produce_block( fc::seconds(60) );
+   BOOST_REQUIRE_EQUAL( success(), execdue( N(carol), 10 ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "0,CERO"), mvo()
+      ("balance", "0 CERO")
+   );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "300 CERO")
+   );
+
+   BOOST_REQUIRE_EQUAL( error("missing authority of alice"), cancelorder( N(bob), 0 ) );
+   BOOST_REQUIRE_EQUAL( success(), cancelorder( N(alice), 0 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "standing order not found" ), cancelorder( N(alice), 0 ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "period must be at least 60 seconds" ),
+                        addorder( N(alice), N(bob), asset::from_string("1 CERO"), 59, first_due ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "first due time is in the past" ),
+                        addorder( N(alice), N(bob), asset::from_string("1 CERO"), 60, first_due ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "period overflows the due time" ),
+                        addorder( N(alice), N(bob), asset::from_string("1 CERO"), 60,
+                                  fc::time_point_sec( std::numeric_limits<uint32_t>::max() - 30 ) ) );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( autoclose_tests, eosio_token_tester ) try {
+
+   auto token = create( N(alice), asset::from_string("1000 CERO"));
+   BOOST_REQUIRE_EQUAL( success(), issue( N(alice), N(alice), asset::from_string("1000 CERO"), "issue" ) );
+   BOOST_REQUIRE_EQUAL( success(), open( N(carol), "0,CERO", N(alice) ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "auto-close is not enabled for this symbol" ),
+                        sweepzero( N(bob), "0,CERO", { N(carol) } ) );
+   BOOST_REQUIRE_EQUAL( error("missing authority of alice"),
+                        setautoclose( N(bob), "0,CERO", true ) );
+   BOOST_REQUIRE_EQUAL( success(), setautoclose( N(alice), "0,CERO", true ) );
+
+   // a balance reaching zero takes its row with it
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(alice), N(bob), asset::from_string("1000 CERO"), "hola" ) );
+   BOOST_REQUIRE_EQUAL( true, get_account(N(alice), "0,CERO").is_null() );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "1000 CERO")
+   );
+
+   // rows that were already empty are swept, non-empty ones are left alone
+   BOOST_REQUIRE_EQUAL( success(), sweepzero( N(bob), "0,CERO", { N(carol), N(bob), N(alice) } ) );
+   BOOST_REQUIRE_EQUAL( true, get_account(N(carol), "0,CERO").is_null() );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "1000 CERO")
+   );
+
+   BOOST_REQUIRE_EQUAL( success(), setautoclose( N(alice), "0,CERO", false ) );
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(bob), N(alice), asset::from_string("1000 CERO"), "hola" ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "0 CERO")
+   );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( standing_order_after_sweep_tests, eosio_token_tester ) try {
+
+   auto token = create( N(alice), asset::from_string("1000 CERO"));
+   BOOST_REQUIRE_EQUAL( success(), issue( N(alice), N(alice), asset::from_string("250 CERO"), "issue" ) );
+   BOOST_REQUIRE_EQUAL( success(), setautoclose( N(alice), "0,CERO", true ) );
+
+   auto first_due = fc::time_point_sec( control->head_block_time() + fc::seconds(10) );
+   BOOST_REQUIRE_EQUAL( success(), addorder( N(alice), N(bob), asset::from_string("100 CERO"), 60, first_due ) );
+
+   // the empty row opened for the order is swept before the order runs
+   BOOST_REQUIRE_EQUAL( success(), sweepzero( N(carol), "0,CERO", { N(bob) } ) );
+   BOOST_REQUIRE_EQUAL( true, get_account(N(bob), "0,CERO").is_null() );
+
+   const auto& rlm = control->get_resource_limits_manager();
+   const auto token_ram = rlm.get_account_ram_usage( N(eosio.token) );
+
+   // execdue does not re-create the row on the contract's RAM, the period is skipped
+   produce_block( fc::seconds(10) );
+   BOOST_REQUIRE_EQUAL( success(), execdue( N(carol), 10 ) );
+   BOOST_REQUIRE_EQUAL( true, get_account(N(bob), "0,CERO").is_null() );
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "0,CERO"), mvo()
+      ("balance", "250 CERO")
+   );
+   BOOST_REQUIRE_EQUAL( token_ram, rlm.get_account_ram_usage( N(eosio.token) ) );
+
+   // once the recipient opens its row again the next period is paid
+   BOOST_REQUIRE_EQUAL( success(), open( N(bob), "0,CERO", N(bob) ) );
+   BOOST_REQUIRE_EQUAL( success(), execdue( N(carol), 10 ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "0 CERO")
+   );
+   produce_block( fc::seconds(60) );
+   BOOST_REQUIRE_EQUAL( success(), execdue( N(carol), 10 ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "0,CERO"), mvo()
+      ("balance", "150 CERO")
+   );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "100 CERO")
+   );
+
+   // drained by a transfer and auto-closed: skipped again, still without contract RAM
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(bob), N(carol), asset::from_string("100 CERO"), "hola" ) );
+   BOOST_REQUIRE_EQUAL( true, get_account(N(bob), "0,CERO").is_null() );
+
+   produce_block( fc::seconds(60) );
+   BOOST_REQUIRE_EQUAL( success(), execdue( N(carol), 10 ) );
+   BOOST_REQUIRE_EQUAL( true, get_account(N(bob), "0,CERO").is_null() );
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "0,CERO"), mvo()
+      ("balance", "150 CERO")
+   );
+   BOOST_REQUIRE_EQUAL( token_ram, rlm.get_account_ram_usage( N(eosio.token) ) );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( core_symbol_tests, eosio_token_tester ) try {
+
+   // the core-symbol fast path relies on create pinning the configured precision
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "core symbol must use the configured precision" ),
+                        create( N(alice), asset::from_string("1000.00 BOS") ) );
+   BOOST_REQUIRE_EQUAL( success(), create( N(alice), asset::from_string("1000.0000 BOS") ) );
+
+   BOOST_REQUIRE_EQUAL( success(), issue( N(alice), N(bob), asset::from_string("500.0000 BOS"), "hola" ) );
+   REQUIRE_MATCHING_OBJECT( get_stats("4,BOS"), mvo()
+      ("supply", "500.0000 BOS")
+      ("max_supply", "1000.0000 BOS")
+      ("issuer", "alice")
+   );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "4,BOS"), mvo()
+      ("balance", "500.0000 BOS")
+   );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "quantity exceeds available supply" ),
+                        issue( N(alice), N(alice), asset::from_string("500.0001 BOS"), "hola" ) );
+
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(bob), N(alice), asset::from_string("200.0000 BOS"), "hola" ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "4,BOS"), mvo()
+      ("balance", "200.0000 BOS")
+   );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "overdrawn balance" ),
+                        transfer( N(bob), N(alice), asset::from_string("300.0001 BOS"), "hola" ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "must transfer positive quantity" ),
+                        transfer( N(bob), N(alice), asset::from_string("-1.0000 BOS"), "hola" ) );
+
+   // other precisions of the core code fall back to the generic path
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "symbol precision mismatch" ),
+                        transfer( N(bob), N(alice), asset::from_string("1.00 BOS"), "hola" ) );
+
+   // draining a row still honours auto-close on the fast path
+   BOOST_REQUIRE_EQUAL( success(), setautoclose( N(alice), "4,BOS", true ) );
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(bob), N(alice), asset::from_string("300.0000 BOS"), "hola" ) );
+   BOOST_REQUIRE_EQUAL( true, get_account(N(bob), "4,BOS").is_null() );
+
+   BOOST_REQUIRE_EQUAL( success(), retire( N(alice), asset::from_string("500.0000 BOS"), "hola" ) );
+   BOOST_REQUIRE_EQUAL( true, get_account(N(alice), "4,BOS").is_null() );
+   REQUIRE_MATCHING_OBJECT( get_stats("4,BOS"), mvo()
+      ("supply", "0.0000 BOS")
+      ("max_supply", "1000.0000 BOS")
+      ("issuer", "alice")
+   );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( transferseq_tests, eosio_token_tester ) try {
+
+   auto token = create( N(alice), asset::from_string("1000 CERO"));
+   BOOST_REQUIRE_EQUAL( success(), issue( N(alice), N(alice), asset::from_string("1000 CERO"), "issue" ) );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "sequence number must be positive" ),
+                        transferseq( N(alice), N(bob), asset::from_string("1 CERO"), "hola", 0 ) );
+
+   BOOST_REQUIRE_EQUAL( success(), transferseq( N(alice), N(bob), asset::from_string("1 CERO"), "hola", 1 ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "0,CERO"), mvo()
+      ("balance", "999 CERO")
+      ("seq", 1)
+   );
+
+   // replays and stale numbers are rejected, gaps are allowed
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "sequence number already used" ),
+                        transferseq( N(alice), N(bob), asset::from_string("2 CERO"), "hola", 1 ) );
+   BOOST_REQUIRE_EQUAL( success(), transferseq( N(alice), N(bob), asset::from_string("2 CERO"), "hola", 5 ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "sequence number already used" ),
+                        transferseq( N(alice), N(bob), asset::from_string("3 CERO"), "hola", 3 ) );
+
+   // plain transfers leave the counter alone
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(alice), N(bob), asset::from_string("7 CERO"), "hola" ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "0,CERO"), mvo()
+      ("balance", "990 CERO")
+      ("seq", 5)
+   );
+
+   // a sequenced row survives being drained under auto-close
+   BOOST_REQUIRE_EQUAL( success(), setautoclose( N(alice), "0,CERO", true ) );
+   BOOST_REQUIRE_EQUAL( success(), transferseq( N(alice), N(bob), asset::from_string("990 CERO"), "hola", 6 ) );
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "0,CERO"), mvo()
+      ("balance", "0 CERO")
+      ("seq", 6)
+   );
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
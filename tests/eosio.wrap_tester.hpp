@@ -0,0 +1,165 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <boost/test/unit_test.hpp>
+#include <eosio/testing/tester.hpp>
+#include <eosio/chain/abi_serializer.hpp>
+
+#include <fc/variant_object.hpp>
+
+#include "contracts.hpp"
+
+using namespace eosio::testing;
+using namespace eosio;
+using namespace eosio::chain;
+using namespace fc;
+
+using mvo = fc::mutable_variant_object;
+
+class eosio_wrap_tester : public tester {
+public:
+
+   eosio_wrap_tester() {
+      create_accounts( { N(eosio.msig), N(prod1), N(prod2), N(prod3), N(prod4), N(prod5), N(alice), N(bob), N(carol) } );
+      produce_block();
+
+
+      base_tester::push_action(config::system_account_name, N(setpriv),
+                                 config::system_account_name,  mutable_variant_object()
+                                 ("account", "eosio.msig")
+                                 ("is_priv", 1)
+      );
+
+      set_code( N(eosio.msig), contracts::msig_wasm() );
+      set_abi( N(eosio.msig), contracts::msig_abi().data() );
+
+      produce_blocks();
+
+      signed_transaction trx;
+      set_transaction_headers(trx);
+      authority auth( 1, {}, {{{config::system_account_name, config::active_name}, 1}} );
+      trx.actions.emplace_back( vector<permission_level>{{config::system_account_name, config::active_name}},
+                                newaccount{
+                                   .creator  = config::system_account_name,
+                                   .name     = N(eosio.wrap),
+                                   .owner    = auth,
+                                   .active   = auth,
+                                });
+
+      set_transaction_headers(trx);
+      trx.sign( get_private_key( config::system_account_name, "active" ), control->get_chain_id()  );
+      push_transaction( trx );
+
+      base_tester::push_action(config::system_account_name, N(setpriv),
+                                 config::system_account_name,  mutable_variant_object()
+                                 ("account", "eosio.wrap")
+                                 ("is_priv", 1)
+      );
+
+      auto system_private_key = get_private_key( config::system_account_name, "active" );
+      set_code( N(eosio.wrap), contracts::wrap_wasm(), &system_private_key );
+      set_abi( N(eosio.wrap), contracts::wrap_abi().data(), &system_private_key );
+
+      produce_blocks();
+
+      set_authority( config::system_account_name, config::active_name,
+                     authority( 1, {{get_public_key( config::system_account_name, "active" ), 1}},
+                                   {{{config::producers_account_name, config::active_name}, 1}} ),
+                     config::owner_name,
+                     { { config::system_account_name, config::owner_name } },
+                     { get_private_key( config::system_account_name, "active" ) }
+                   );
+
+      set_producers( {N(prod1), N(prod2), N(prod3), N(prod4), N(prod5)} );
+
+      produce_blocks();
+
+      const auto& accnt = control->db().get<account_object,by_name>( N(eosio.wrap) );
+      abi_def abi;
+      BOOST_REQUIRE_EQUAL(abi_serializer::to_abi(accnt.abi, abi), true);
+      abi_ser.set_abi(abi, abi_serializer_max_time);
+
+      while( control->pending_block_state()->header.producer.to_string() == "eosio" ) {
+         produce_block();
+      }
+   }
+
+   void propose( name proposer, name proposal_name, vector<permission_level> requested_permissions, const transaction& trx ) {
+      push_action( N(eosio.msig), N(propose), proposer, mvo()
+                     ("proposer",      proposer)
+                     ("proposal_name", proposal_name)
+                     ("requested",     requested_permissions)
+                     ("trx",           trx)
+      );
+   }
+
+   void approve( name proposer, name proposal_name, name approver ) {
+      push_action( N(eosio.msig), N(approve), approver, mvo()
+                     ("proposer",      proposer)
+                     ("proposal_name", proposal_name)
+                     ("level",         permission_level{approver, config::active_name} )
+      );
+   }
+
+   void unapprove( name proposer, name proposal_name, name unapprover ) {
+      push_action( N(eosio.msig), N(unapprove), unapprover, mvo()
+                     ("proposer",      proposer)
+                     ("proposal_name", proposal_name)
+                     ("level",         permission_level{unapprover, config::active_name})
+      );
+   }
+
+   transaction wrap_exec( account_name executer, const transaction& trx, uint32_t expiration = base_tester::DEFAULT_EXPIRATION_DELTA,
+                          action_name exec_action = N(exec) );
+
+   transaction reqauth( account_name from, const vector<permission_level>& auths, uint32_t expiration = base_tester::DEFAULT_EXPIRATION_DELTA );
+
+   abi_serializer abi_ser;
+};
+
+inline transaction eosio_wrap_tester::wrap_exec( account_name executer, const transaction& trx, uint32_t expiration, action_name exec_action ) {
+   fc::variants v;
+   v.push_back( fc::mutable_variant_object()
+                  ("actor", executer)
+                  ("permission", name{config::active_name})
+              );
+  v.push_back( fc::mutable_variant_object()
+                 ("actor", "eosio.wrap")
+                 ("permission", name{config::active_name})
+             );
+   auto act_obj = fc::mutable_variant_object()
+                     ("account", "eosio.wrap")
+                     ("name", exec_action)
+                     ("authorization", v)
+                     ("data", fc::mutable_variant_object()("executer", executer)("trx", trx) );
+   transaction trx2;
+   set_transaction_headers(trx2, expiration);
+   action act;
+   abi_serializer::from_variant( act_obj, act, get_resolver(), abi_serializer_max_time );
+   trx2.actions.push_back( std::move(act) );
+   return trx2;
+}
+
+inline transaction eosio_wrap_tester::reqauth( account_name from, const vector<permission_level>& auths, uint32_t expiration ) {
+   fc::variants v;
+   for ( auto& level : auths ) {
+      v.push_back(fc::mutable_variant_object()
+                  ("actor", level.actor)
+                  ("permission", level.permission)
+      );
+   }
+   auto act_obj = fc::mutable_variant_object()
+                     ("account", name{config::system_account_name})
+                     ("name", "reqauth")
+                     ("authorization", v)
+                     ("data", fc::mutable_variant_object() ("from", from) );
+   transaction trx;
+   set_transaction_headers(trx, expiration);
+   action act;
+   abi_serializer::from_variant( act_obj, act, get_resolver(), abi_serializer_max_time );
+   trx.actions.push_back( std::move(act) );
+   return trx;
+}